@@ -0,0 +1,62 @@
+#pragma once
+
+// Box2D settings used when Box2D and the engine are both built with B2_USER_SETTINGS defined
+//
+// Box2D includes this file in place of its default settings, so inc/ must be on Box2D's include path too.
+// Everything is the same as the defaults except b2Alloc and b2Free, which account Box2D's memory to
+// MemoryCategory::BOX2D. Without B2_USER_SETTINGS Box2D uses its own allocator and is not counted.
+//
+// Only Box2D's types can be used here as this file is included from inside Box2D's headers.
+
+#include <stdarg.h>
+#include <stdint.h>
+
+// Tunable constants (the Box2D defaults)
+
+#define b2_lengthUnitsPerMeter 1.0f
+
+#define b2_maxPolygonVertices 8
+
+// User data (the Box2D defaults)
+
+struct B2_API b2BodyUserData
+{
+	b2BodyUserData() { pointer = 0; }
+
+	uintptr_t pointer;
+};
+
+struct B2_API b2FixtureUserData
+{
+	b2FixtureUserData() { pointer = 0; }
+
+	uintptr_t pointer;
+};
+
+struct B2_API b2JointUserData
+{
+	b2JointUserData() { pointer = 0; }
+
+	uintptr_t pointer;
+};
+
+// Memory allocation (defined in src/util/memoryTracker.cpp)
+
+void* b2TrackedAlloc(int32 size);
+void b2TrackedFree(void* memory);
+
+inline void* b2Alloc(int32 size) { return b2TrackedAlloc(size); }
+
+inline void b2Free(void* memory) { b2TrackedFree(memory); }
+
+// Logging (the Box2D default)
+
+B2_API void b2Log_Default(const char* string, va_list args);
+
+inline void b2Log(const char* string, ...)
+{
+	va_list args;
+	va_start(args, string);
+	b2Log_Default(string, args);
+	va_end(args);
+}
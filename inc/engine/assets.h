@@ -0,0 +1,172 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief Ref-counted handle to an asset owned by the AssetCache
+*/
+template<typename ASSET>
+using AssetHandle = std::shared_ptr<ASSET>;
+
+/*
+* @brief Entry of the texture manifest (res/json/textures.json)
+*/
+struct TextureManifestEntry
+{
+	// Name the texture is referenced by (in level files)
+	std::string name;
+
+	// Path of the texture relative to the asset root directory
+	std::string path;
+};
+
+/*
+* @brief List of assets to load ahead of time
+*/
+struct AssetManifest
+{
+	// Paths of the fonts relative to the asset root directory
+	std::vector<std::string> fonts;
+
+	// Paths of the fragment shaders relative to the asset root directory
+	std::vector<std::string> shaders;
+
+	// Textures listed in the texture manifest
+	std::vector<TextureManifestEntry> textures;
+};
+
+/*
+* @brief Builds the default manifest of all the fonts in res/fonts, the fragment shaders in glsl and the textures in the texture manifest
+*
+* @param rootDirectory Directory all the asset paths are relative to
+*
+* @return The manifest of all the assets found
+*/
+AssetManifest loadAssetManifest(const std::string& rootDirectory);
+
+/*
+* @brief Loads each asset once and hands out ref-counted handles to it
+*/
+class AssetCache
+{
+	private:
+		// Directory all the asset paths are relative to
+		std::filesystem::path rootDirectory;
+
+		// Loaded assets (keyed by their normalised path)
+		std::unordered_map<std::string, AssetHandle<sf::Font>> fonts;
+		std::unordered_map<std::string, AssetHandle<sf::Shader>> shaders;
+		std::unordered_map<std::string, AssetHandle<sf::Texture>> textures;
+
+		// Decoded texture images (kept on the CPU so they can be packed into atlases without a GPU round trip)
+		std::unordered_map<std::string, AssetHandle<sf::Image>> images;
+
+		// Assets being loaded on background threads. Only the disk read and decoding is done on
+		// the worker threads, anything that needs an OpenGL context is finished on the main thread
+		std::unordered_map<std::string, std::future<AssetHandle<sf::Font>>> pendingFonts;
+		std::unordered_map<std::string, std::future<std::string>> pendingShaders;
+		std::unordered_map<std::string, std::future<AssetHandle<sf::Image>>> pendingTextures;
+
+		// Errors of background loads that failed (thrown by the getter of the asset the next time it is requested)
+		std::unordered_map<std::string, std::string> failedLoads;
+
+		// Number of assets requested by the last preload
+		size_t preloadTotal = 0;
+
+		/*
+		* @brief Converts a path to the key used by the maps so different spellings of the same file are deduplicated
+		*/
+		static std::string normalise(const std::string& path);
+
+		/*
+		* @brief Gets the full path of an asset on disk
+		*/
+		std::string fullPath(const std::string& key) const;
+
+		/*
+		* @brief Throws the error of a failed background load of an asset (once)
+		*/
+		void throwIfFailed(const std::string& key);
+
+		/*
+		* @brief Turns the source of a fragment shader into a usable shader (main thread only)
+		*/
+		AssetHandle<sf::Shader> compileShader(const std::string& key, const std::string& source);
+
+		/*
+		* @brief Uploads a decoded image to a texture (main thread only)
+		*/
+		AssetHandle<sf::Texture> uploadTexture(const std::string& key, const sf::Image& image);
+
+	public:
+		/*
+		* @brief Constructor
+		*
+		* @param rootDirectory Directory all asset paths are relative to
+		*/
+		AssetCache(const std::string& rootDirectory);
+
+		/*
+		* @brief Destructor. Waits for any background loads to finish
+		*/
+		~AssetCache();
+
+		/*
+		* @brief Gets a font, loading it if it has not been loaded yet
+		*
+		* @param path Path of the font relative to the root directory
+		*/
+		AssetHandle<sf::Font> getFont(const std::string& path);
+
+		/*
+		* @brief Gets a fragment shader, loading it if it has not been loaded yet
+		*
+		* @param path Path of the shader relative to the root directory
+		*/
+		AssetHandle<sf::Shader> getShader(const std::string& path);
+
+		/*
+		* @brief Gets a texture, loading it if it has not been loaded yet
+		*
+		* @param path Path of the texture relative to the root directory
+		*/
+		AssetHandle<sf::Texture> getTexture(const std::string& path);
+
+		/*
+		* @brief Gets the decoded image of a texture without uploading it to the GPU
+		*
+		* @param path Path of the texture relative to the root directory
+		*/
+		AssetHandle<sf::Image> getImage(const std::string& path);
+
+		/*
+		* @brief Starts loading all the assets in the manifest on background threads
+		*
+		* @param manifest Assets to load
+		*/
+		void preload(const AssetManifest& manifest);
+
+		/*
+		* @brief Finishes any background loads that are ready. Called by the engine every frame
+		*
+		* Loads that failed are printed and their error is thrown by the next get of that asset instead
+		*/
+		void update();
+
+		/*
+		* @brief Blocks until all background loads are finished
+		*/
+		void waitForPreload();
+
+		/*
+		* @brief Gets how much of the last preload is finished
+		*
+		* @return Value between 0 and 1
+		*/
+		float getPreloadProgress() const;
+
+		/*
+		* @brief Removes every asset that is only referenced by the cache
+		*/
+		void releaseUnused();
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <engine/assets.h>
+
+#include <util/util.h>
+
+/*
+* @brief Settings used when packing the atlas pages
+*/
+struct AtlasSettings
+{
+	// Maximum width and height of a page (clamped to what the GPU supports)
+	unsigned int maxPageSize = 2048;
+
+	// Pixels around each texture filled with its edge pixels so filtering does not bleed between textures
+	unsigned int padding = 2;
+
+	// Every texture starts on a multiple of this so the first mip levels do not mix neighbouring textures
+	unsigned int alignment = 4;
+
+	// Whether mipmaps are generated for the pages
+	bool generateMipmaps = true;
+};
+
+/*
+* @brief Where a texture ended up inside the atlas
+*/
+struct AtlasRegion
+{
+	// Page the texture was packed into
+	const sf::Texture* page = nullptr;
+
+	// Rectangle of the texture inside the page (in pixels, as SFML texture coordinates are)
+	sf::FloatRect textureRect;
+};
+
+/*
+* @brief Packs many small textures into a few large pages so sprites can share a texture
+*/
+class TextureAtlas
+{
+	private:
+		// Textures of each page
+		std::vector<std::unique_ptr<sf::Texture>> pages;
+
+		// Regions of every packed texture (keyed by the name in the manifest)
+		std::unordered_map<std::string, AtlasRegion> regions;
+
+		// Estimated GPU memory of the pages
+		TrackedMemory pageMemory{ MemoryCategory::ASSETS };
+
+	public:
+		/*
+		* @brief Packs all the textures into as few pages as possible. Replaces any previous pages
+		*
+		* @param assets Cache the texture images are loaded from
+		* @param textures Textures to pack (normally from the texture manifest)
+		* @param settings Packing settings
+		*/
+		void build(AssetCache& assets, const std::vector<TextureManifestEntry>& textures, const AtlasSettings& settings = AtlasSettings());
+
+		/*
+		* @brief Finds the region of a texture
+		*
+		* @param name Name of the texture in the manifest
+		*
+		* @return Pointer to the region or nullptr if the texture is not in the atlas
+		*/
+		const AtlasRegion* find(const std::string& name) const;
+
+		/*
+		* @brief Gets the number of pages in the atlas
+		*/
+		size_t getPageCount() const { return pages.size(); }
+
+		/*
+		* @brief Gets the texture of a page
+		*/
+		const sf::Texture& getPage(size_t index) const { return *pages[index]; }
+};
@@ -1,11 +1,26 @@
 #pragma once
 
+#include <engine/assets.h>
+#include <engine/renderQueue.h>
+#include <engine/atlas.h>
+#include <engine/shapeCache.h>
+#include <engine/input.h>
+#include <engine/scheduler.h>
+#include <engine/metrics.h>
+#include <engine/governor.h>
+#include <engine/simulationLod.h>
+
 #include <util/util.h>
 
 // Foward declaration of engine classes
 class PhysicalEntity;
 class Entity;
 class Engine;
+class LevelLoad;
+struct Level;
+struct PhysicalDef;
+class Prefab;
+class ParticleSystem;
 
 /*
 * @brief Simple class with a static pointer to the engine instance
@@ -25,6 +40,8 @@ class EngineSubClass
 */
 struct B2CustomUserData : public EngineSubClass
 {
+	TRACK_MEMORY(MemoryCategory::USER_DATA)
+
 	/*
 	* @brief Embedded class for contact information
 	*/
@@ -36,8 +53,9 @@ struct B2CustomUserData : public EngineSubClass
 	// Pointer to the owner of the body
 	Entity* owner;
 
-	// Vector of contact information
-	std::unordered_map<Entity*, ContatctInfo> contacts;
+	// Contact information of every entity touching the body (accounted to the user data category)
+	std::unordered_map<Entity*, ContatctInfo, std::hash<Entity*>, std::equal_to<Entity*>,
+		TrackingAllocator<std::pair<Entity* const, ContatctInfo>, MemoryCategory::USER_DATA>> contacts;
 
 	// Current gravity on the body
 	float gravityStrength = 0.0f;
@@ -53,6 +71,7 @@ enum class EntityType
 {
 	GRAPHIC_ONLY,
 	GRAPHIC_PHYSICAL,
+	STATIC_CHAIN,
 
 	UNDEFINED
 };
@@ -68,6 +87,18 @@ enum class EditorState
 	INACTIVE
 };
 
+/*
+* @brief Enum class for where the engine renders to
+*/
+enum class WindowMode
+{
+	WINDOWED,
+	FULLSCREEN,
+
+	// No window is created, everything is only rendered into the render texture
+	OFFSCREEN
+};
+
 /*
 * @brief Base polymorphic class for all entities
 */
@@ -77,6 +108,8 @@ class Entity : public EngineSubClass
 		// Allow the engine and world to access the private functions
 		friend class World;
 		friend class Engine;
+		friend class SimulationLOD;
+		friend class LevelLoad;
 
 		// Vector of all instances of Entity
 		static std::vector<std::unique_ptr<Entity>> instances;
@@ -106,11 +139,44 @@ class Entity : public EngineSubClass
 		//
 		bool selectedByEditor = false;
 
+		// Whether the entity's pre and post step updates are skipped this step as it is far from the view (set by SimulationLOD)
+		bool skippedUpdate = false;
+
+		// Whether the entity is part of a level still being loaded by a LevelLoad (its body is disabled and it does not update)
+		bool loading = false;
+
+		// Id given to the next entity that is created
+		static uint64_t nextId;
+
+		// Unique id of the entity (never reused, unlike its address)
+		uint64_t id;
+
+		// Incremented every time something that is saved in a level file changes
+		uint64_t revision = 0;
+
+		/*
+		* @brief Marks the entity as changed so it is saved again by a LevelSaver
+		*/
+		void markDirty() { revision++; }
+
 	public:
+		// Every entity (of any subclass) is accounted to the entities category
+		TRACK_MEMORY(MemoryCategory::ENTITIES)
+
 		/*
 		*/
 		Entity();
 
+		/*
+		* @brief Gets the unique id of the entity
+		*/
+		uint64_t getId() const { return id; }
+
+		/*
+		* @brief Gets the revision of the entity. Changes whenever something that is saved in a level file changes
+		*/
+		uint64_t getRevision() const { return revision; }
+
 		/*
 		* @brief Virtual deconstructor to allow for polymorphism
 		*/
@@ -148,39 +214,39 @@ class Entity : public EngineSubClass
 		void setPosition(Vec2 position);
 
 		/*
+		* @brief Removes an entity and destroys it (and its body)
+		*
+		* @param entity Entity to remove
 		*/
 		static void remove(Entity* entity);
-};
-
-/*
-* @brief Base polymorphic class for all EngineControllers
-*/
-class EngineController : public EngineSubClass
-{
-	private:
-		// Allow the engine to access the private functions
-		friend class Engine;
 
 		/*
-		* @brief Function called when the engine is created which calls the init function and any child controllers
+		* @brief Removes many entities in one pass over the instances (unloading a chunk for example)
+		*
+		* @param entities Entities to remove
 		*/
-		void onInit();
-
-		/*
-		* @brief Function called when the engine is rendered which calls the render function and any child controllers
-		*/
-		void onRender();
-
-		/*
-		* @brief Function called when the engine is updated which calls the update function and any child controllers
-		*/
-		void onUpdate();
+		static void remove(const std::unordered_set<Entity*>& entities);
 
 		/*
+		* @brief Makes space for more entities so creating many at once does not keep reallocating
 		* 
+		* @param count Number of entities that are about to be created
 		*/
-		void onClose();
+		static void reserve(size_t count)
+		{
+			size_t needed = instances.size() + count;
 
+			// Grows at least geometrically so reserving for every streamed chunk does not move every instance each time
+			if (needed > instances.capacity())
+				instances.reserve(std::max(needed, instances.capacity() * 2));
+		}
+};
+
+/*
+* @brief Base polymorphic class for all EngineControllers
+*/
+class EngineController : public EngineSubClass
+{
 	public:
 		/*
 		* @brief Default constructor. Should never be called
@@ -203,7 +269,7 @@ class EngineController : public EngineSubClass
 		virtual void render() {}
 
 		/*
-		* @brief Virtual function called when the engine is updated
+		* @brief Virtual function called when the engine is updated (may be called on a worker thread, see getAccess)
 		*/
 		virtual void update() {}
 
@@ -212,7 +278,15 @@ class EngineController : public EngineSubClass
 		*/
 		virtual void close() {}
 
-		// Child controller
+		/*
+		* @brief Virtual function giving what update reads and writes, so independent controllers can update in parallel
+		* 
+		* Called once when the controller is added. By default a controller uses everything on the main thread, so it
+		* always updates on its own, in order
+		*/
+		virtual SystemAccess getAccess() const { return SystemAccess(); }
+
+		// Child controller (added to the engine as its own system straight after its parent)
 		std::unique_ptr<EngineController> childController;
 };
 
@@ -222,6 +296,9 @@ class EngineController : public EngineSubClass
 class Engine
 {
 	private:
+		// Allows removed entities to clear the editor's pointers to them
+		friend class Entity;
+
 		// Count of the number of instances of the engine
 		static size_t instanceCount;
 
@@ -296,11 +373,8 @@ class Engine
 		// Position of the mouse
 		Vec2 mousePos;
 
-		// Map of all the keys that are currently being pressed
-		static std::unordered_map<sf::Keyboard::Key, long> keyMap;
-
-		// Map of all the mouse buttons that are currently being pressed
-		static std::unordered_map<sf::Mouse::Button, long> mouseMap;
+		// State of every key and mouse button (built from the window events)
+		InputState input;
 
 		// Window the engine is rendering to
 		sf::RenderWindow window;
@@ -308,12 +382,64 @@ class Engine
 		// Render texture of the window
 		sf::RenderTexture windowRenderTexture;
 
+		// Estimated GPU memory of the render texture
+		TrackedMemory renderTextureMemory{ MemoryCategory::RENDER_TEXTURES };
+
+		// Executes the command buffers recorded this frame once the controllers have rendered
+		RenderQueue renderQueue;
+
+		// Particles of the game (added to the scheduler as a system, owned by extraSystems)
+		ParticleSystem* particleSystem = nullptr;
+
 		//
 		sf::VertexArray windowDisplayQuad;
 
 		//
 		sf::Clock engineClock;
 
+		// Where the engine is rendering to
+		WindowMode windowMode;
+
+		// Used instead of the window being open when rendering offscreen
+		bool running = true;
+
+		// Number of frames rendered
+		size_t frameCount = 0;
+
+		// Number of updates (used to print the memory use every MEMORY_DUMP_INTERVAL updates)
+		size_t updateCount = 0;
+
+		// When the last update started (the frame time metric is the time between updates)
+		std::chrono::steady_clock::time_point lastUpdateStart;
+
+		// Time the last update and render spent working (what the governor is fed, milliseconds)
+		float lastUpdateMs = 0.0f;
+		float lastRenderMs = 0.0f;
+
+		// Whether hitboxes and chain outlines are drawn (the governor can also turn them off)
+		bool debugDrawing = true;
+
+		// Copies the render texture to the CPU every this many frames (0 to never copy)
+		unsigned int readbackInterval = 0;
+
+		// Last frame copied back from the render texture
+		sf::Image lastReadback;
+
+		/*
+		* @brief Polls the window events and updates the mouse position, inputs and editor (skipped offscreen)
+		*/
+		void updateInput();
+
+		/*
+		* @brief Records the b2World profile and counts for this frame in the metrics
+		*/
+		void recordPhysicsMetrics();
+
+		/*
+		* @brief Drops the editor's pointers to entities that are about to be removed
+		*/
+		void forgetEntities(const std::unordered_set<Entity*>& removed);
+
 		//
 		EditorState editorState = EditorState::INACTIVE;
 
@@ -323,6 +449,32 @@ class Engine
 		//
 		std::vector<Entity*> possibleEditorEntities;
 
+		// Font used by the editor panel (loaded once through the asset cache)
+		AssetHandle<sf::Font> editorFont;
+
+		// Shader applied when the render texture is drawn to the window (can be null)
+		AssetHandle<sf::Shader> postProcessShader;
+
+		// Levels being loaded with loadLevelAsync
+		std::vector<std::shared_ptr<LevelLoad>> levelLoads;
+
+		// Prefabs registered by name
+		std::unordered_map<std::string, std::unique_ptr<Prefab>> prefabs;
+
+		// Controllers added with addSystem
+		std::vector<std::unique_ptr<EngineController>> extraSystems;
+
+		// Updates the controllers, in parallel where their access allows
+		SystemScheduler systems;
+
+		// Whether the controllers have been initialised (systems added later are initialised straight away)
+		bool systemsInitialised = false;
+
+		/*
+		* @brief Adds a controller and its chain of child controllers to the scheduler
+		*/
+		void addSystemChain(EngineController* controller);
+
 	public:
 		// b2World the game is simulating
 		b2World* world;
@@ -333,7 +485,26 @@ class Engine
 		// Scale of the engine
 		static const float pxToMeter;
 
-		sf::Shader testShader;
+		// Cache of all the fonts, shaders and textures used by the engine
+		AssetCache assets;
+
+		// Atlas of every texture in the texture manifest (shared by all textured entities)
+		TextureAtlas atlas;
+
+		// Cache of the hitbox shapes (shared by all entities with the same hitbox)
+		ShapeCache shapes;
+
+		// Worker threads (one per core other than the main thread) for controllers and gameplay code to run jobs on
+		JobSystem jobs;
+
+		// Per-frame physics, render and memory counters with their rolling percentiles (controllers can add their own)
+		MetricsRegistry metrics;
+
+		// Lowers the solver iterations, debug drawing, post processing and far entity updates while frames run over budget
+		FrameGovernor governor;
+
+		// Steps dynamic bodies far from the view less often and disables the furthest ones
+		SimulationLOD simulationLOD;
 
 		/*
 		* @brief Constructor for the engine
@@ -342,7 +513,17 @@ class Engine
 		* @param controller Controller for the engine
 		* @param fullscreen Whether the window should be fullscreen
 		*/
-		Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller = nullptr, bool fullscreen = false);
+		Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller = nullptr, bool fullscreen = false)
+			: Engine(windowSize, std::move(controller), fullscreen ? WindowMode::FULLSCREEN : WindowMode::WINDOWED) {}
+
+		/*
+		* @brief Constructor for the engine
+		* 
+		* @param windowSize Size of the window
+		* @param controller Controller for the engine
+		* @param mode Where the engine renders to (OFFSCREEN renders without a window, for tests and benchmarks)
+		*/
+		Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller, WindowMode mode);
 
 		/*
 		* @brief Destructor for the engine
@@ -350,22 +531,106 @@ class Engine
 		~Engine();
 
 		/*
-		* @brief Function to update the engine. Automatically calls the controller onUpdate function
+		* @brief Adds another controller to the engine which updates alongside the main one
+		* 
+		* @param system Controller to add
+		* 
+		* @return The controller
+		*/
+		EngineController* addSystem(std::unique_ptr<EngineController> system);
+
+		/*
+		* @brief Gets the number of waves the controllers update in (1 when they all update in parallel)
+		*/
+		size_t getSystemWaveCount() { return systems.getWaveCount(); }
+
+		/*
+		* @brief Function to update the engine. Automatically updates every controller
 		*/
 		void update();
 
 		/*
-		* @brief Function to render the engine. Automatically calls the controller onRender function
+		* @brief Function to render the engine. Automatically renders every controller in the order they were added
 		*/
 		void render();
 
 		/*
-		* @brief Function to draw a drawable object to the window
+		* @brief Function to record a copy of a drawable object into the main command buffer (so locals and temporaries are safe)
 		* 
-		* @param drawable Drawable object to draw
+		* @param drawable Drawable object to draw. Its textures and fonts must stay alive until the end of the frame
 		* @param renderStates Render states of the object
+		* @param layer Layer the object is drawn on (higher layers are drawn on top)
+		* @param depth Depth within the layer (higher depths are drawn on top of draws with the same render states only)
+		*/
+		template<typename DRAWABLE>
+		void draw(const DRAWABLE& drawable, sf::RenderStates renderStates = sf::RenderStates::Default, int layer = 0, float depth = 0.0f) { renderQueue.getMainBuffer().copy(drawable, renderStates, layer, depth); }
+
+		/*
+		* @brief Function to record a copy of a text into the main command buffer
+		*/
+		void draw(const sf::Text& text, sf::RenderStates renderStates = sf::RenderStates::Default, int layer = 0, float depth = 0.0f) { renderQueue.getMainBuffer().text(text, renderStates, layer, depth); }
+
+		/*
+		* @brief Function to record a drawable object into the main command buffer without copying it
+		* 
+		* @param drawable Drawable object to draw. Must stay alive until the end of the frame
+		* @param renderStates Render states of the object
+		* @param layer Layer the object is drawn on (higher layers are drawn on top)
+		* @param depth Depth within the layer (higher depths are drawn on top of draws with the same render states only)
+		*/
+		void drawPersistent(const sf::Drawable& drawable, sf::RenderStates renderStates = sf::RenderStates::Default, int layer = 0, float depth = 0.0f) { renderQueue.getMainBuffer().custom(drawable, renderStates, layer, depth); }
+
+		/*
+		* @brief Temporaries would be destroyed before the frame is drawn (use draw, which copies them)
+		*/
+		void drawPersistent(const sf::Drawable&& drawable, sf::RenderStates renderStates = sf::RenderStates::Default, int layer = 0, float depth = 0.0f) = delete;
+
+		/*
+		* @brief Gets the command buffer the main thread records into. Executed at the end of Engine::render
+		*/
+		CommandBuffer& getCommandBuffer() { return renderQueue.getMainBuffer(); }
+
+		/*
+		* @brief Adds a command buffer recorded on another thread to the current frame (thread safe)
+		* 
+		* @param buffer Recorded buffer
+		*/
+		void submit(CommandBuffer&& buffer) { renderQueue.submit(std::move(buffer)); }
+
+		/*
+		* @brief Sets the shader applied to the whole screen
+		* 
+		* @param path Path of the fragment shader relative to the asset root directory (empty to remove the shader)
+		*/
+		void setPostProcessShader(const std::string& path);
+
+		/*
+		* @brief Loads a level without blocking. The file is parsed on a worker thread and the entities are created
+		* during Engine::update, spending at most LEVEL_LOAD_BUDGET_MS each frame
+		* 
+		* @param levelPath The path to the JSON or binary level file
+		* @param onComplete Called once every entity has been created (can be empty)
+		* 
+		* @return Handle to check the progress of the load and get the entities
+		*/
+		std::shared_ptr<LevelLoad> loadLevelAsync(const std::string& levelPath, std::function<void(Level&)> onComplete = {});
+
+		/*
+		* @brief Compiles a def into a prefab that can be spawned many times with PhysicalEntity::spawnMany
+		* 
+		* @param name Name of the prefab (replaces any prefab with the same name)
+		* @param def Def every copy is made from
+		* 
+		* @return The registered prefab
 		*/
-		void draw(sf::Drawable& drawable, sf::RenderStates renderStates = sf::RenderStates::Default) { windowRenderTexture.draw(drawable, renderStates); }
+		const Prefab& registerPrefab(const std::string& name, const PhysicalDef& def);
+
+		/*
+		* @brief Gets a registered prefab
+		* 
+		* @param name Name of the prefab
+		*/
+		const Prefab& getPrefab(const std::string& name) const;
 
 		/*
 		* @brief Function to move the view of the engine
@@ -374,22 +639,93 @@ class Engine
 		*/
 		void moveView(Vec2 offset);
 
+		/*
+		* @brief Function to get the centre of the view of the engine
+		* 
+		* @return Centre of the view in pixels
+		*/
+		Vec2 getViewCenter() { return windowRenderTexture.getView().getCenter(); }
+
+		/*
+		* @brief Function to get the size of the view of the engine
+		* 
+		* @return Size of the view in pixels
+		*/
+		Vec2 getViewSize() { return windowRenderTexture.getView().getSize(); }
+
+		/*
+		* @brief Gets the particle system, to add emitters and bursts
+		*/
+		ParticleSystem& getParticles() { return *particleSystem; }
+
+		/*
+		* @brief Gets every entity with a fixture containing a point (what the editor selects from when clicked)
+		* 
+		* @param point Point in meters
+		*/
+		std::vector<Entity*> pickEntities(Vec2 point) { return QueryPoint(world, point); }
+
+		/*
+		* @brief Turns the drawing of hitboxes and chain outlines on or off
+		*/
+		void setDebugDrawing(bool enabled) { debugDrawing = enabled; }
+
+		/*
+		* @brief Checks if hitboxes and chain outlines should be drawn this frame (turned on and allowed by the governor)
+		*/
+		bool isDebugDrawing() const { return debugDrawing && governor.getQuality().debugDrawing; }
+
 		/*
 		* @brief Function to check if the window is open
 		* 
 		* @return Whether the window is open
 		*/
-		bool isRunning() { return window.isOpen(); }
+		bool isRunning() { return (windowMode == WindowMode::OFFSCREEN) ? running : window.isOpen(); }
+
+		/*
+		* @brief Function to stop the engine (closes the window if there is one)
+		*/
+		void stop();
+
+		/*
+		* @brief Sets how often the render texture is copied back to the CPU
+		* 
+		* @param interval Copies every this many frames (0 to never copy)
+		*/
+		void setReadbackInterval(unsigned int interval) { readbackInterval = interval; }
+
+		/*
+		* @brief Gets the last frame copied back from the render texture
+		*/
+		const sf::Image& getLastReadback() { return lastReadback; }
+
+		/*
+		* @brief Blocks until the GPU has finished drawing into the render texture
+		* 
+		* Drivers (Mesa's software renderer especially) defer the drawing, so a render is only fully timed once this
+		* returns. Slow, only meant for benchmarks
+		*/
+		void finishRendering();
+
+		/*
+		* @brief Gets the number of frames rendered
+		*/
+		size_t getFrameCount() { return frameCount; }
+
+		/*
+		* @brief Gets the number of draw calls the last frame made into the render texture
+		*/
+		size_t getDrawCount() { return renderQueue.getDrawCount(); }
 
 		/*
 		* @brief Gets frames since held / frames held for
 		*/
-		long getInputInfo(sf::Keyboard::Key key);
+		long getInputInfo(sf::Keyboard::Key key) { return input.getInfo(key); }
 
 		/*
 		* @brief Gets frames since held / frames held for
 		*/
-		long getInputInfo(sf::Mouse::Button button);
+		long getInputInfo(sf::Mouse::Button button) { return input.getInfo(button); }
 
 		/*
 		* @brief Function to check if a key is pressed
@@ -412,18 +748,64 @@ class Engine
 		bool isClicked(sf::Mouse::Button button) { return getInputInfo(button) == 1; }
 
 		/*
-		* @brief Function to add a keybord key to the engine
+		* @brief Gets frames since held / frames held for of an action (whichever of its bindings was held longest)
+		*/
+		long getActionInfo(const std::string& action) const { return input.getActionInfo(action); }
+
+		/*
+		* @brief Function to check if any input bound to an action is pressed
+		*/
+		bool isActionPressed(const std::string& action) const { return input.getActionInfo(action) > 0; }
+
+		/*
+		* @brief Function to check if an action is clicked (first frame pressed)
+		*/
+		bool isActionClicked(const std::string& action) const { return input.getActionInfo(action) == 1; }
+
+		/*
+		* @brief Function to bind a key or mouse button to an action
+		* 
+		* @param action Name of the action
+		* @param binding Key or mouse button to bind
+		*/
+		template <typename INPUT_TYPE>
+		void bindAction(const std::string& action, INPUT_TYPE binding)
+		{
+			// Checks the type of the input is valid
+			static_assert (
+				std::is_same<INPUT_TYPE, sf::Keyboard::Key>::value ||
+				std::is_same<INPUT_TYPE, sf::Mouse::Button>::value,
+				"Invalid input type"
+			);
+
+			// LControl is kept for the editor
+			if constexpr (std::is_same<INPUT_TYPE, sf::Keyboard::Key>::value)
+			{
+				if (binding == sf::Keyboard::Key::LControl)
+					throw std::runtime_error("Error: cannot bind LControl to an action");
+			}
+
+			input.bindAction(action, binding);
+		}
+
+		/*
+		* @brief Gets an upper bound of the time from input events to the display of the first frame stepped with them
+		*/
+		InputLatencyStats getInputLatency() const { return input.getLatencyStats(); }
+
+		/*
+		* @brief Function to add a keybord key to the engine (every key is tracked, this only checks the key can be used)
 		* 
 		* @param key Key to add
 		*/
 		void addInput(sf::Keyboard::Key key);
 
 		/*
-		* @brief Function to add a mouse button to the engine
+		* @brief Function to add a mouse button to the engine (every button is tracked so this does nothing)
 		* 
 		* @param button Mouse button to add
 		*/
-		void addInput(sf::Mouse::Button button);
+		void addInput(sf::Mouse::Button button) {}
 
 		/* 
 		* @brief Function to get the position of the mouse
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief Enum class for the type of a recorded render command
+*/
+enum class RenderCommandType
+{
+	QUAD,
+	LINES,
+	TEXT,
+	CUSTOM
+};
+
+/*
+* @brief A single recorded draw
+*/
+struct RenderCommand
+{
+	// Type of the command
+	RenderCommandType type;
+
+	// Layer and depth the command is drawn at
+	int layer;
+	float depth;
+
+	// Render states the command is drawn with
+	sf::RenderStates states;
+
+	// For QUAD and LINES the range of vertices the command uses, for TEXT and CUSTOM the index of the text / drawable
+	uint32_t first;
+	uint32_t count;
+};
+
+/*
+* @brief Records draws so the engine can sort, batch and cull them before anything is drawn
+* 
+* A CommandBuffer is not thread safe, but each thread can record into its own buffer and submit it to the engine
+*/
+class CommandBuffer
+{
+	private:
+		// Allow the render queue to read the commands
+		friend class RenderQueue;
+
+		// Recorded commands
+		std::vector<RenderCommand> commands;
+
+		// Vertices of the QUAD and LINES commands (quads are stored as 4 vertices in triangle strip order)
+		std::vector<sf::Vertex> vertices;
+
+		// Copies of the recorded texts
+		std::vector<sf::Text> texts;
+
+		// Custom drawables (not copied so they must stay alive until the frame is drawn)
+		std::vector<const sf::Drawable*> drawables;
+
+		// Drawables recorded with copy (owned by the buffer until it is cleared)
+		std::vector<std::unique_ptr<sf::Drawable>> copies;
+
+		/*
+		* @brief Adds a command
+		*/
+		void addCommand(RenderCommandType type, const sf::RenderStates& states, int layer, float depth, size_t first, size_t count);
+
+	public:
+		/*
+		* @brief Records a quad
+		* 
+		* @param corners The 4 corners of the quad in triangle strip order (top left, top right, bottom left, bottom right)
+		* @param states Render states of the quad
+		* @param layer Layer the quad is drawn on
+		* @param depth Depth within the layer (only orders commands with the same render states)
+		*/
+		void quad(const sf::Vertex* corners, const sf::RenderStates& states = sf::RenderStates::Default, int layer = 0, float depth = 0.0f);
+
+		/*
+		* @brief Records a list of lines (every 2 vertices is a line)
+		* 
+		* @param vertexCount Number of vertices (2 per line)
+		* @param states Render states of the lines
+		* @param layer Layer the lines are drawn on
+		* @param depth Depth within the layer (only orders commands with the same render states)
+		* 
+		* @return Pointer to the vertices to fill in. Only valid until the next command is recorded
+		*/
+		sf::Vertex* lines(size_t vertexCount, const sf::RenderStates& states = sf::RenderStates::Default, int layer = 0, float depth = 0.0f);
+
+		/*
+		* @brief Records a text (the text is copied, the font must stay alive until the frame is drawn)
+		* 
+		* @param text Text to draw
+		* @param states Render states of the text
+		* @param layer Layer the text is drawn on
+		* @param depth Depth within the layer (only orders commands with the same render states)
+		*/
+		void text(const sf::Text& text, const sf::RenderStates& states = sf::RenderStates::Default, int layer = 0, float depth = 0.0f);
+
+		/*
+		* @brief Records any drawable. Custom drawables can not be batched or culled
+		* 
+		* @param drawable Drawable object. Must stay alive until the frame is drawn
+		* @param states Render states of the drawable
+		* @param layer Layer the drawable is drawn on
+		* @param depth Depth within the layer (only orders commands with the same render states)
+		*/
+		void custom(const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default, int layer = 0, float depth = 0.0f);
+
+		/*
+		* @brief Temporaries would be destroyed long before the frame is drawn (use copy instead)
+		*/
+		void custom(const sf::Drawable&& drawable, const sf::RenderStates& states = sf::RenderStates::Default, int layer = 0, float depth = 0.0f) = delete;
+
+		/*
+		* @brief Records a copy of a drawable, so it can be a local or a temporary (shapes and sprites for example)
+		* 
+		* @param drawable Drawable object, copied into the buffer. The textures and fonts it uses must stay alive until the frame is drawn
+		* @param states Render states of the drawable
+		* @param layer Layer the drawable is drawn on
+		* @param depth Depth within the layer (only orders commands with the same render states)
+		*/
+		template<typename DRAWABLE>
+		void copy(const DRAWABLE& drawable, const sf::RenderStates& states = sf::RenderStates::Default, int layer = 0, float depth = 0.0f)
+		{
+			static_assert(std::is_base_of<sf::Drawable, DRAWABLE>::value, "Error: only drawables can be recorded");
+			static_assert(!std::is_abstract<DRAWABLE>::value, "Error: a drawable only known by its base class cannot be copied, record it with custom and keep it alive");
+
+			copies.push_back(std::make_unique<DRAWABLE>(drawable));
+			custom(*copies.back(), states, layer, depth);
+		}
+
+		/*
+		* @brief Removes all the recorded commands (keeps the memory)
+		*/
+		void clear();
+
+		/*
+		* @brief Gets the number of recorded commands
+		*/
+		size_t size() const { return commands.size(); }
+
+		/*
+		* @brief Checks if nothing has been recorded
+		*/
+		bool empty() const { return commands.empty(); }
+};
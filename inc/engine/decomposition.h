@@ -0,0 +1,75 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief Checks if a polygon is convex (collinear vertices are allowed)
+* 
+* @param outline Vertices of the polygon in either winding order
+*/
+bool isConvex(const std::vector<Vec2>& outline);
+
+/*
+* @brief Splits a simple polygon into convex pieces that Box2D can use as polygon shapes
+* 
+* Triangulates the polygon by ear clipping then merges neighbouring pieces back together (Hertel-Mehlhorn)
+* while they stay convex and within the vertex limit. Convex outlines within the limit are returned as they are
+* 
+* @param outline Vertices of a simple polygon (no self intersections) in either winding order
+* @param maxVertices Largest number of vertices a piece can have
+* 
+* @return The convex pieces (counter-clockwise)
+*/
+std::vector<std::vector<Vec2>> decomposeConvex(const std::vector<Vec2>& outline, size_t maxVertices = b2_maxPolygonVertices);
+
+/*
+* @brief Cache of convex decompositions kept in memory and on disk so an outline is only ever split once
+* 
+* Each outline is stored in a file named after the hash of its vertices, along with the outline itself so a
+* hash collision is never mistaken for a match
+*/
+class DecompositionCache
+{
+	private:
+		// Directory the decompositions are written to (empty to only cache in memory)
+		std::string directory;
+
+		// Decompositions keyed by the bytes of their outline
+		std::unordered_map<std::string, std::vector<std::vector<Vec2>>> decompositions;
+
+		// Number of outlines that had to be decomposed
+		size_t decomposedCount = 0;
+
+		/*
+		* @brief Reads a decomposition from the disk
+		* 
+		* @return False if it is not on the disk (or the file does not match the outline)
+		*/
+		bool readFromDisk(const std::string& path, const std::vector<Vec2>& outline, std::vector<std::vector<Vec2>>& pieces) const;
+
+		/*
+		* @brief Writes a decomposition to the disk (failures are ignored as the cache is only an optimisation)
+		*/
+		void writeToDisk(const std::string& path, const std::vector<Vec2>& outline, const std::vector<std::vector<Vec2>>& pieces) const;
+
+	public:
+		/*
+		* @brief Creates the cache
+		* 
+		* @param directory Directory the decompositions are written to (empty to only cache in memory)
+		*/
+		DecompositionCache(const std::string& directory = "");
+
+		/*
+		* @brief Gets the convex pieces of an outline, decomposing it only if it has never been decomposed before
+		* 
+		* @param outline Vertices of a simple polygon
+		* @param key Bytes of the outline (the same key the ShapeCache uses)
+		*/
+		const std::vector<std::vector<Vec2>>& get(const std::vector<Vec2>& outline, const std::string& key);
+
+		/*
+		* @brief Gets the number of outlines that had to be decomposed (not found in memory or on the disk)
+		*/
+		size_t getDecomposedCount() const { return decomposedCount; }
+};
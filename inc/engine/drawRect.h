@@ -1,5 +1,8 @@
 #pragma once
 
+#include <engine/commandBuffer.h>
+#include <engine/atlas.h>
+
 #include <util/util.h>
 
 /*
@@ -17,6 +20,9 @@ class drawRect : public sf::Drawable
 		// Vertices of the rectangle
 		sf::VertexArray vertices;
 
+		// Texture the rectangle samples from (nullptr for a flat color)
+		const sf::Texture* texture = nullptr;
+
 		/*
 		* @brief Updates the vertices of the rectangle
 		*/
@@ -58,6 +64,28 @@ class drawRect : public sf::Drawable
 		/**/
 		void setColor(sf::Color color);
 
+		/*
+		* @brief Sets the texture of the rectangle to a region of the texture atlas
+		* 
+		* @param region Region of the atlas to use (nullptr to go back to a flat color)
+		*/
+		void setTexture(const AtlasRegion* region);
+
+		/*
+		* @brief Gets the texture the rectangle is drawn with (nullptr if it is a flat color)
+		*/
+		const sf::Texture* getTexture() const { return texture; }
+
+		/*
+		* @brief Records the rectangle as a quad so it can be batched with other rectangles
+		* 
+		* @param buffer Command buffer to record into
+		* @param states SFML Render states
+		* @param layer Layer the rectangle is drawn on
+		* @param depth Depth within the layer
+		*/
+		void record(CommandBuffer& buffer, sf::RenderStates states, int layer = 0, float depth = 0.0f) const;
+
 		/*
 		* @brief Draws the rectangle
 		* 
@@ -2,7 +2,24 @@
 
 // Include all the headers in the engine
 
+#include <engine/assets.h>
+#include <engine/atlas.h>
 #include <engine/base.h>
+#include <engine/commandBuffer.h>
 #include <engine/drawRect.h>
+#include <engine/renderQueue.h>
+#include <engine/shapeCache.h>
 #include <engine/entity.h>
-#include <engine/level.h>
\ No newline at end of file
+#include <engine/level.h>
+#include <engine/levelBinary.h>
+#include <engine/worldStream.h>
+#include <engine/levelLoad.h>
+#include <engine/levelSaver.h>
+#include <engine/levelWatcher.h>
+#include <engine/input.h>
+#include <engine/jobs.h>
+#include <engine/scheduler.h>
+#include <engine/metrics.h>
+#include <engine/governor.h>
+#include <engine/simulationLod.h>
+#include <engine/particles.h>
@@ -9,6 +9,9 @@
 // Foward declaration of the B2CustomUserData class
 struct B2CustomUserData;
 
+// Foward declaration of the Prefab class
+class Prefab;
+
 /*
 * @brief Converts a string to a b2BodyType
 * 
@@ -34,6 +37,16 @@ struct GraphicDef
 {
 	Vec2 size;
 	Vec2 position;
+
+	// Name of the texture in the texture manifest (empty for a flat color)
+	std::string texture;
+
+	// Layer the entity is drawn on (higher layers are drawn on top)
+	int layer = 0;
+
+	// Depth of the entity within its layer (higher depths are drawn on top of entities with the same texture and
+	// shader only, draws are grouped by state first so use layers to order entities with different textures)
+	float depth = 0.0f;
 };
 
 /*
@@ -63,9 +76,43 @@ class GraphicEntity : public Entity
 		// Friends the def creation function
 		friend GraphicDef createDefOf(GraphicEntity* entity);
 
+		// Friends the prefab class to let it look up its texture once
+		friend class Prefab;
+
 		// Drawable object of the entity
 		drawRect drawable;
 
+		// Name of the texture the entity is drawn with (empty for a flat color)
+		std::string textureName;
+
+		// Layer and depth the entity is drawn at
+		int layer = 0;
+		float depth = 0.0f;
+
+		/*
+		* @brief Sets the texture of the drawable from the engine's texture atlas
+		* 
+		* @param name: Name of the texture in the texture manifest (empty for a flat color)
+		*/
+		void setTexture(const std::string& name);
+
+		/*
+		* @brief Finds a texture in the engine's texture atlas
+		* 
+		* @param name: Name of the texture in the texture manifest (empty for a flat color)
+		* 
+		* @return The region of the texture (nullptr for a flat color)
+		*/
+		static const AtlasRegion* findTexture(const std::string& name);
+
+		/*
+		* @brief Sets the size, position and drawable of a new entity from its def
+		* 
+		* @param def: Definition of the entity
+		* @param region: Texture of the entity (already looked up from def.texture)
+		*/
+		void initGraphic(const GraphicDef& def, const AtlasRegion* region);
+
 		/*
 		* @brief True constructor of the class
 		* 
@@ -84,6 +131,22 @@ class GraphicEntity : public Entity
 		*/
 		void render() override;
 
+		/*
+		* @brief Sets the draw order of the entity
+		* 
+		* @param layer: Layer the entity is drawn on (higher layers are drawn on top)
+		* @param depth: Depth within the layer (higher depths are drawn on top of entities with the same texture and
+		* shader, use layers to order entities with different ones)
+		*/
+		void setDrawOrder(int layer, float depth);
+
+		/*
+		* @brief Moves the entity (and its drawable) straight to a position
+		* 
+		* @param position: New position of the entity
+		*/
+		virtual void teleport(Vec2 position);
+
 		/*
 		* @brief Creates a graphic entity and adds it to the instances vector
 		* 
@@ -91,7 +154,7 @@ class GraphicEntity : public Entity
 		* 
 		* @return A shared pointer to the created entity
 		*/
-		static GraphicEntity* create(GraphicDef def);
+		static GraphicEntity* create(const GraphicDef& def);
 };
 
 /*
@@ -102,6 +165,12 @@ class PhysicalEntity : public GraphicEntity
 	private:
 		// Friends the engine class to allow it to access it's private members
 		friend class Engine;
+
+		// Friends the simulation LOD to let it disable and sleep the body
+		friend class SimulationLOD;
+
+		// Friends the level load to keep the body disabled until its whole level exists
+		friend class LevelLoad;
 		 
 		// Friends the def creation function
 		friend PhysicalDef createDefOf(PhysicalEntity* entity);
@@ -109,12 +178,15 @@ class PhysicalEntity : public GraphicEntity
 		// Pointer to the b2Body of the entity
 		b2Body* body = nullptr;
 
-		// Vector of shared pointers to the shapes of the fixtures
-		std::vector<std::shared_ptr<b2Shape>> shapes;
+		// Hitboxes of the body (each one has a fixture for each of its convex pieces)
+		std::vector<std::shared_ptr<const Hitbox>> hitboxes;
 
 		// Velocity of the entity
 		Vec2 velocity;
 
+		// How often the body is simulated (set by SimulationLOD)
+		SimulationTier simulationTier = SimulationTier::FULL;
+
 		/**/
 		void preStepUpdate() override;
 
@@ -128,6 +200,15 @@ class PhysicalEntity : public GraphicEntity
 		*/
 		PhysicalEntity(bool call);
 
+		/*
+		* @brief Creates the b2Body of a new entity at its position
+		* 
+		* @param bodyType: Type of the body
+		* @param bodyHitboxes: Hitboxes of the body
+		* @param createFixtures: False to give the body no fixtures
+		*/
+		void initBody(b2BodyType bodyType, const std::vector<std::shared_ptr<const Hitbox>>& bodyHitboxes, bool createFixtures);
+
 	public:
 		/*
 		* @brief Default constructor of the class - Calls the true constructor with parameter true
@@ -172,6 +253,13 @@ class PhysicalEntity : public GraphicEntity
 		*/
 		void addVelocity(Vec2 velocity);
 
+		/*
+		* @brief Moves the entity straight to a position, keeping its b2Body and contacts
+		* 
+		* @param position: New position of the entity
+		*/
+		void teleport(Vec2 position) override;
+
 		/*
 		* @brief Gets the user data of the b2Body
 		*/
@@ -181,10 +269,113 @@ class PhysicalEntity : public GraphicEntity
 		* @brief Creates a physical entity and adds it to the instances vector
 		* 
 		* @param Definition of the entity
+		* @param createFixtures: False to give the body no fixtures (used when the hitboxes were merged into a StaticChainEntity)
 		* 
 		* @return A shared pointer to the created entity
 		*/
-		static PhysicalEntity* create(PhysicalDef def);
+		static PhysicalEntity* create(const PhysicalDef& def, bool createFixtures = true);
+
+		/*
+		* @brief Creates many copies of a prefab in one go
+		* 
+		* The texture and hitboxes were resolved when the prefab was registered and the instances vector only grows once
+		* 
+		* @param prefab: Prefab to copy
+		* @param positions: Position of each copy
+		* @param count: Number of copies
+		* 
+		* @return Pointers to the created entities (in the same order as the positions)
+		*/
+		static std::vector<PhysicalEntity*> spawnMany(const Prefab& prefab, const Vec2* positions, size_t count);
+
+		/*
+		* @brief Creates many copies of a prefab in one go
+		* 
+		* @param prefab: Prefab to copy
+		* @param positions: Position of each copy
+		* 
+		* @return Pointers to the created entities (in the same order as the positions)
+		*/
+		static std::vector<PhysicalEntity*> spawnMany(const Prefab& prefab, const std::vector<Vec2>& positions) { return spawnMany(prefab, positions.data(), positions.size()); }
+};
+
+/*
+* @brief A PhysicalDef compiled once so it can be spawned many times
+* 
+* The texture is looked up and the hitboxes are built when the prefab is made instead of for every copy
+*/
+class Prefab : public EngineSubClass
+{
+	private:
+		// Lets spawnMany use the resolved texture and hitboxes
+		friend class PhysicalEntity;
+
+		// Def every copy is made from (the position is replaced by the position of each copy)
+		PhysicalDef def;
+
+		// Texture of the copies
+		const AtlasRegion* region = nullptr;
+
+		// Hitboxes of the copies (shared by every copy)
+		std::vector<std::shared_ptr<const Hitbox>> hitboxes;
+
+	public:
+		/*
+		* @brief Compiles a def into a prefab
+		* 
+		* @param def: Def every copy is made from
+		*/
+		Prefab(const PhysicalDef& def);
+
+		/*
+		* @brief Gets the def every copy is made from
+		*/
+		const PhysicalDef& getDef() const { return def; }
+};
+
+/*
+* @brief Static body made of chain loops, generated when touching static boxes are merged at load time
+* 
+* Has no drawable (the merged entities still draw themselves) and is never saved to level files
+*/
+class StaticChainEntity : public Entity
+{
+	private:
+		// Pointer to the b2Body of the entity
+		b2Body* body = nullptr;
+
+		// Outlines of the chains in world space
+		std::vector<std::vector<Vec2>> loops;
+
+	public:
+		/*
+		* @brief Constructor of the class
+		*/
+		StaticChainEntity();
+
+		/*
+		* @brief Destructor of the class - Destroys the b2Body and its userData
+		*/
+		~StaticChainEntity();
+
+		/*
+		* @brief Renders the outlines of the chains on the debug layer
+		*/
+		void render() override;
+
+		/*
+		* @brief Gets the outlines of the chains in world space
+		*/
+		const std::vector<std::vector<Vec2>>& getLoops() const { return loops; }
+
+		/*
+		* @brief Creates a static body with a chain loop for each outline and adds it to the instances vector
+		* 
+		* @param loops: Closed outlines in world space (counter-clockwise around solid areas, clockwise around holes)
+		* 
+		* @return A pointer to the created entity
+		*/
+		static StaticChainEntity* create(const std::vector<std::vector<Vec2>>& loops);
 };
 
 /*
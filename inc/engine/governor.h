@@ -0,0 +1,102 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief What the engine does at one quality level
+*/
+struct QualityLevel
+{
+	// Iterations of the Box2D solver each step (fewer iterations make stacks softer)
+	int velocityIterations = 8;
+	int positionIterations = 3;
+
+	// Whether hitboxes and chain outlines are drawn (when debug drawing is also turned on)
+	bool debugDrawing = true;
+
+	// Whether the post process shader is applied
+	bool postProcess = true;
+
+	// Multiplies the interval bodies far from the view are stepped at (see SimulationLOD, 1 for the normal interval)
+	unsigned int farUpdateInterval = 1;
+};
+
+/*
+* @brief Lowers the quality of the engine while frames run over budget and raises it again once there is headroom
+*
+* Fed the time each frame spent working (excluding the wait for the frame limit). Quality drops one level as soon as
+* the smoothed time has been over budget for GOVERNOR_DOWNGRADE_FRAMES frames and only rises one level after
+* GOVERNOR_UPGRADE_FRAMES frames well under budget, so it does not flicker between levels.
+*/
+class FrameGovernor
+{
+	private:
+		// Quality levels from the best (0) to the cheapest
+		std::vector<QualityLevel> levels;
+
+		// Level in use
+		size_t level = 0;
+
+		// Time a frame is allowed to spend working (milliseconds)
+		float budgetMs = GOVERNOR_BUDGET_MS;
+
+		// Exponential moving average of the frame time (milliseconds)
+		float smoothedMs = 0.0f;
+
+		// Consecutive frames over budget and well under budget
+		unsigned int overBudgetFrames = 0;
+		unsigned int underBudgetFrames = 0;
+
+		// Whether the level changes (when disabled the best level is always used)
+		bool enabled = GOVERNOR_ENABLED;
+
+	public:
+		/*
+		* @brief Starts with the default levels (full quality, no debug drawing, no post processing, throttled far entities)
+		*/
+		FrameGovernor();
+
+		/*
+		* @brief Adds the time a frame spent working and changes level if needed
+		*
+		* @param frameMs Time spent in the update and render of the frame (milliseconds)
+		*
+		* @return Whether the level changed
+		*/
+		bool addFrame(float frameMs);
+
+		/*
+		* @brief Replaces the quality levels (best first). Goes back to the best level
+		*/
+		void setLevels(const std::vector<QualityLevel>& newLevels);
+
+		/*
+		* @brief Gets the settings of the level in use
+		*/
+		const QualityLevel& getQuality() const { return levels[level]; }
+
+		/*
+		* @brief Gets the level in use (0 is the best)
+		*/
+		size_t getLevel() const { return level; }
+
+		/*
+		* @brief Gets the number of quality levels
+		*/
+		size_t getLevelCount() const { return levels.size(); }
+
+		/*
+		* @brief Gets the smoothed frame time (milliseconds)
+		*/
+		float getSmoothedFrameTime() const { return smoothedMs; }
+
+		/*
+		* @brief Sets the time a frame is allowed to spend working (milliseconds)
+		*/
+		void setBudget(float milliseconds) { budgetMs = milliseconds; }
+
+		/*
+		* @brief Turns the governor on or off (going back to the best level when turned off)
+		*/
+		void setEnabled(bool isEnabled);
+};
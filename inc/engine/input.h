@@ -0,0 +1,183 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief Upper bound of the latency from an input event to the display of the first frame stepped with it
+*
+* SFML does not timestamp events, so an event is counted from the poll before the one that received it (the earliest
+* it could have arrived). This includes the wait for the next poll, the update and render, and the wait in display
+*/
+struct InputLatencyStats
+{
+	// Number of events measured since the stats were last reset
+	size_t samples = 0;
+
+	// Latency of the measured events in milliseconds
+	float meanMs = 0.0f;
+	float p95Ms = 0.0f;
+	float maxMs = 0.0f;
+};
+
+/*
+* @brief Keyboard and mouse state built from window events
+*
+* Each key and button has a counter in a fixed array indexed by its code: positive values are the number of
+* frames it has been held for (1 on the frame it was pressed) and negative values are the number of frames
+* since it was released (0 if it has never been pressed). A key pressed and released between two frames
+* still counts as held for one frame so the press is never missed.
+*/
+class InputState
+{
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		/*
+		* @brief Keys and mouse buttons an action is bound to
+		*/
+		struct ActionBinding
+		{
+			std::vector<sf::Keyboard::Key> keys;
+			std::vector<sf::Mouse::Button> buttons;
+		};
+
+		// Frames held / frames since released of every key and mouse button
+		std::array<long, sf::Keyboard::KeyCount> keyFrames = {};
+		std::array<long, sf::Mouse::ButtonCount> buttonFrames = {};
+
+		// Whether each key and mouse button is down according to the events polled so far
+		std::array<bool, sf::Keyboard::KeyCount> keyDown = {};
+		std::array<bool, sf::Mouse::ButtonCount> buttonDown = {};
+
+		// Keys and mouse buttons that were pressed since the last frame (even if they have been released again)
+		std::array<bool, sf::Keyboard::KeyCount> keyLatched = {};
+		std::array<bool, sf::Mouse::ButtonCount> buttonLatched = {};
+
+		// Actions by name
+		std::unordered_map<std::string, ActionBinding> actions;
+
+		// Time of the last poll and of the poll before it (events received by the last poll arrived after the one before)
+		Clock::time_point lastPoll;
+		Clock::time_point previousPoll;
+
+		// Earliest times the presses polled since the last step could have arrived
+		std::vector<Clock::time_point> pendingPresses;
+
+		// Presses that have been stepped but not displayed yet
+		std::vector<Clock::time_point> steppedPresses;
+
+		// Most recent latency samples (a ring buffer) and the totals of every sample since the last reset
+		static constexpr size_t LATENCY_HISTORY = 256;
+		std::array<float, LATENCY_HISTORY> latencyHistory = {};
+		size_t latencyCount = 0;
+		double latencyTotal = 0.0;
+		float latencyMax = 0.0f;
+
+		/*
+		* @brief Advances the counter of one key or button by a frame
+		*/
+		static void advance(long& frames, bool held)
+		{
+			if (held)
+				frames = frames > 0 ? frames + 1 : 1;
+
+			else
+				frames = frames < 0 ? frames - 1 : (frames > 0 ? -1 : 0);
+		}
+
+		/*
+		* @brief Gets the binding of an action (throws if it does not exist)
+		*/
+		const ActionBinding& getAction(const std::string& action) const;
+
+	public:
+		/*
+		* @brief Marks the start of a poll of the window events (call before polling)
+		*
+		* @param time When the poll started
+		*/
+		void beginPoll(Clock::time_point time);
+
+		/*
+		* @brief Updates the down state from a window event
+		*
+		* @param event Event that was polled
+		*
+		* @return True if the event was an input event
+		*/
+		bool handleEvent(const sf::Event& event);
+
+		/*
+		* @brief Releases every key and mouse button (used when the window loses focus as the releases will never arrive)
+		*/
+		void releaseAll();
+
+		/*
+		* @brief Moves the counters on by a frame using the events polled since the last frame
+		*
+		* @param advanceCounters False to keep the counters as they are (the latched presses are still cleared)
+		*/
+		void endFrame(bool advanceCounters = true);
+
+		/*
+		* @brief Marks every press polled since the last step as stepped (call just before stepping)
+		*/
+		void onStep();
+
+		/*
+		* @brief Records the latency of every stepped press (call once the frame has been displayed)
+		*
+		* @param time When the frame was displayed
+		*/
+		void onDisplay(Clock::time_point time);
+
+		/*
+		* @brief Gets frames held / frames since released of a key
+		*/
+		long getInfo(sf::Keyboard::Key key) const { return key >= 0 && key < sf::Keyboard::KeyCount ? keyFrames[key] : 0; }
+
+		/*
+		* @brief Gets frames held / frames since released of a mouse button
+		*/
+		long getInfo(sf::Mouse::Button button) const { return button >= 0 && button < sf::Mouse::ButtonCount ? buttonFrames[button] : 0; }
+
+		/*
+		* @brief Checks if a key is down right now (by the events polled so far, ignores the frame counters)
+		*/
+		bool isDown(sf::Keyboard::Key key) const { return key >= 0 && key < sf::Keyboard::KeyCount && keyDown[key]; }
+
+		/*
+		* @brief Checks if a mouse button is down right now (by the events polled so far, ignores the frame counters)
+		*/
+		bool isDown(sf::Mouse::Button button) const { return button >= 0 && button < sf::Mouse::ButtonCount && buttonDown[button]; }
+
+		/*
+		* @brief Binds a key to an action (an action can have any number of keys and mouse buttons)
+		*/
+		void bindAction(const std::string& action, sf::Keyboard::Key key);
+
+		/*
+		* @brief Binds a mouse button to an action
+		*/
+		void bindAction(const std::string& action, sf::Mouse::Button button);
+
+		/*
+		* @brief Removes every binding of an action
+		*/
+		void unbindAction(const std::string& action) { actions.erase(action); }
+
+		/*
+		* @brief Gets frames held / frames since released of an action (the binding held the longest, or released most recently)
+		*/
+		long getActionInfo(const std::string& action) const;
+
+		/*
+		* @brief Gets the input to display latency of the presses measured since the last reset (an upper bound)
+		*/
+		InputLatencyStats getLatencyStats() const;
+
+		/*
+		* @brief Clears the latency samples
+		*/
+		void resetLatencyStats();
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief Set of jobs that can be waited on together
+*/
+class JobGroup
+{
+	private:
+		friend class JobSystem;
+
+		// Number of jobs in the group that have not finished
+		std::atomic<size_t> pending{ 0 };
+
+		// First exception thrown by a job of the group (rethrown by JobSystem::wait)
+		std::exception_ptr error;
+		std::mutex errorMutex;
+
+	public:
+		JobGroup() = default;
+
+		JobGroup(const JobGroup&) = delete;
+		JobGroup& operator=(const JobGroup&) = delete;
+
+		/*
+		* @brief Checks if every job of the group has finished
+		*/
+		bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+/*
+* @brief Handle to a job scheduled with dependencies (cheap to copy)
+*/
+class JobHandle
+{
+	private:
+		friend class JobSystem;
+
+		/*
+		* @brief Shared state of a job scheduled with JobSystem::schedule
+		*/
+		struct State
+		{
+			std::function<void()> function;
+
+			// Dependencies that have not finished (plus one while the job is being scheduled)
+			std::atomic<size_t> waitingOn{ 1 };
+
+			// Whether the job has run (or been skipped because a dependency threw)
+			std::atomic<bool> finished{ false };
+
+			// Jobs waiting for this one, guarded by mutex
+			std::vector<std::shared_ptr<State>> dependents;
+			std::mutex mutex;
+
+			// Exception thrown by the job or by one of its dependencies
+			std::exception_ptr error;
+		};
+
+		std::shared_ptr<State> state;
+
+		JobHandle(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+	public:
+		JobHandle() = default;
+
+		/*
+		* @brief Checks if the handle refers to a job
+		*/
+		bool isValid() const { return state != nullptr; }
+
+		/*
+		* @brief Checks if the job has finished (an empty handle counts as finished)
+		*/
+		bool isDone() const { return state == nullptr || state->finished.load(std::memory_order_acquire); }
+};
+
+/*
+* @brief Pool of worker threads that share work by stealing it from each other
+*
+* Each worker has its own queue and takes the newest job from it, so related jobs stay on the same core.
+* A worker with nothing to do takes the oldest job from another queue. Threads waiting on jobs run
+* other jobs while they wait rather than blocking.
+*/
+class JobSystem
+{
+	private:
+		/*
+		* @brief Job waiting to run
+		*/
+		struct Job
+		{
+			std::function<void()> function;
+
+			// Group the job is part of (null for jobs scheduled with dependencies)
+			JobGroup* group;
+		};
+
+		/*
+		* @brief Queue of jobs (one per worker plus one for threads outside the pool)
+		*/
+		struct JobQueue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		// Queues (index 0 is for threads outside the pool, worker i uses queue i)
+		std::vector<std::unique_ptr<JobQueue>> queues;
+
+		// Worker threads
+		std::vector<std::thread> workers;
+
+		// Number of jobs in all the queues (lets idle workers sleep)
+		std::atomic<size_t> queuedCount{ 0 };
+
+		// Number of jobs taken from the queues that have not finished (counted before they leave the queue)
+		std::atomic<size_t> runningCount{ 0 };
+
+		// Wakes idle workers when jobs are added or the pool is stopping
+		std::mutex sleepMutex;
+		std::condition_variable wake;
+
+		// Whether the workers should exit
+		std::atomic<bool> stopping{ false };
+
+		// Queue the next job from outside the pool goes into (spreads them over the workers)
+		std::atomic<size_t> nextQueue{ 0 };
+
+		/*
+		* @brief Adds a job to a queue and wakes a worker
+		*/
+		void push(Job job);
+
+		/*
+		* @brief Takes a job, newest first from the given queue then oldest first from the others
+		*
+		* @return False if every queue is empty
+		*/
+		bool takeJob(size_t ownQueue, Job& job);
+
+		/*
+		* @brief Runs a job and marks it as finished in its group
+		*/
+		void runJob(Job& job);
+
+		/*
+		* @brief Gets the queue of the calling thread (0 if it is not one of the workers)
+		*/
+		size_t getOwnQueue() const;
+
+		/*
+		* @brief Runs one queued job if there is one, otherwise yields
+		*/
+		void helpOrYield(size_t ownQueue);
+
+		/*
+		* @brief Queues a job whose dependencies have all finished
+		*/
+		void enqueueReady(const std::shared_ptr<JobHandle::State>& state);
+
+		/*
+		* @brief Runs a job scheduled with dependencies and releases the jobs waiting for it
+		*/
+		void runScheduled(const std::shared_ptr<JobHandle::State>& state);
+
+		/*
+		* @brief Loop of each worker thread
+		*/
+		void workerLoop(size_t index);
+
+	public:
+		/*
+		* @brief Starts the workers
+		*
+		* @param workerCount Number of worker threads (0 to use one per core other than the calling thread)
+		*/
+		JobSystem(size_t workerCount = 0);
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		/*
+		* @brief Shuts the workers down if shutdown has not been called
+		*/
+		~JobSystem();
+
+		/*
+		* @brief Runs every queued job and waits for the running ones (including the jobs they release), then stops and
+		* joins the workers (no jobs can be added afterwards)
+		*/
+		void shutdown();
+
+		/*
+		* @brief Queues a job
+		*
+		* @param group Group the job is part of (must outlive the job)
+		* @param function Function to run
+		*/
+		void submit(JobGroup& group, std::function<void()> function);
+
+		/*
+		* @brief Runs queued jobs until every job of the group has finished, then rethrows the first exception any of them threw
+		*/
+		void wait(JobGroup& group);
+
+		/*
+		* @brief Schedules a job that runs once all of its dependencies have finished
+		*
+		* If a dependency throws, the job is skipped and the exception is passed on to it
+		*
+		* @param function Function to run
+		* @param dependencies Jobs that must finish first
+		*/
+		JobHandle schedule(std::function<void()> function, const std::vector<JobHandle>& dependencies = {});
+
+		/*
+		* @brief Runs queued jobs until the job has finished, then rethrows any exception it (or a dependency) threw
+		*/
+		void wait(const JobHandle& handle);
+
+		/*
+		* @brief Splits a range into chunks and runs them in parallel (the calling thread runs chunks too)
+		*
+		* @param count Number of items
+		* @param function Function called with the [begin, end) range of each chunk
+		* @param grainSize Items per chunk (0 to split the range into a few chunks per thread)
+		*/
+		void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t grainSize = 0);
+
+		/*
+		* @brief Calls a function on every item of a vector in parallel (Entity::instances for example)
+		*
+		* @param items Items to go through
+		* @param function Function called with each item
+		* @param grainSize Items per chunk (0 to split the vector into a few chunks per thread)
+		*/
+		template<typename ITEM, typename FUNCTION>
+		void parallelForEach(std::vector<ITEM>& items, FUNCTION function, size_t grainSize = 0)
+		{
+			parallelFor(items.size(), [&items, &function](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+					function(items[i]);
+			}, grainSize);
+		}
+
+		/*
+		* @brief Gets the number of worker threads
+		*/
+		size_t getWorkerCount() const { return workers.size(); }
+};
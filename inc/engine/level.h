@@ -18,34 +18,89 @@ struct Level
 {
 	std::vector<GraphicEntity*> graphicEntities;
 	std::vector<PhysicalEntity*> physicalEntities;
+
+	// Bodies generated by merging static boxes (not saved, the merged entities are saved instead)
+	std::vector<StaticChainEntity*> staticChains;
+};
+
+/*
+* @brief Options for loading a level
+*/
+struct LevelLoadOptions
+{
+	// Merges touching static boxes into chain loops on shared bodies (the boxes keep their drawables but lose their fixtures)
+	bool mergeStaticBoxes = false;
+};
+
+/*
+* @brief Static boxes of a level that touch each other and the outline they make
+*/
+struct StaticBoxGroup
+{
+	// Indices of the boxes in LevelDef::physicalEntities
+	std::vector<size_t> defIndices;
+
+	// Closed outlines of the group in world space (counter-clockwise around solid areas, clockwise around holes)
+	std::vector<std::vector<Vec2>> loops;
 };
 
 /*
-* @brief Loads a LevelDef from a JSON file
+* @brief Loads a LevelDef from a JSON or binary level file
 * 
-* @param levelPath The path to the JSON file
+* @param levelPath The path to the JSON or binary level file
 * 
 * @return The LevelDef of the file
 */
 LevelDef loadLevelDef(const std::string& levelPath);
 
+/*
+* @brief Estimates the memory a LevelDef holds (the defs and the strings and vertices they own)
+* 
+* @param levelDef The LevelDef to measure
+* 
+* @return The estimated size in bytes
+*/
+size_t estimateMemory(const LevelDef& levelDef);
+
+/*
+* @brief Parses a JSON level file token by token, calling a function with each entity def as soon as it is read
+* 
+* Only one entity is held in memory at a time. The defs passed to the functions are reused so they must be copied to be kept
+* 
+* @param levelPath The path to the JSON file
+* @param onGraphic Function called with each graphic entity
+* @param onPhysical Function called with each physical entity
+*/
+void streamLevelDef(const std::string& levelPath, const std::function<void(const GraphicDef&)>& onGraphic, const std::function<void(const PhysicalDef&)>& onPhysical);
+
 /*
 * @brief Loads a Level from a LevelDef
 * 
 * @param levelDef The LevelDef to load from
+* @param options How to load the level
 * 
 * @return Pointers to all the entities in the level
 */
-Level loadLevel(const LevelDef& levelDef);
+Level loadLevel(const LevelDef& levelDef, const LevelLoadOptions& options = LevelLoadOptions());
 
 /*
-* @brief Loads a Level from a JSON file
+* @brief Loads a Level from a JSON or binary level file (binary levels are memory mapped and read in place)
 * 
-* @param levelPath The path to the JSON file
+* @param levelPath The path to the JSON or binary level file
+* @param options How to load the level
 * 
 * @return Pointers to all the entities in the level
 */
-Level loadLevel(const std::string& levelPath);
+Level loadLevel(const std::string& levelPath, const LevelLoadOptions& options = LevelLoadOptions());
+
+/*
+* @brief Finds the static axis aligned boxes of a level that touch each other and traces the outline of each group
+* 
+* Only groups of two or more boxes are returned
+* 
+* @param levelDef The level to search
+*/
+std::vector<StaticBoxGroup> findStaticBoxGroups(const LevelDef& levelDef);
 
 /*
 * @brief Saves a LevelDef to a JSON file
@@ -53,4 +108,30 @@ Level loadLevel(const std::string& levelPath);
 * @param levelDef The LevelDef to save
 * @param levelPath The path to the JSON file
 */
-void saveToJson(Level& levelDef, const std::string& levelPath);
\ No newline at end of file
+void saveToJson(Level& levelDef, const std::string& levelPath);
+
+/*
+* @brief Saves a LevelDef to a JSON file
+* 
+* @param levelDef The LevelDef to save
+* @param levelPath The path to the JSON file
+*/
+void saveToJson(const LevelDef& levelDef, const std::string& levelPath);
+
+/*
+* @brief Converts the def of a graphic entity to the JSON object saved in level files
+* 
+* @param def The def to convert
+* 
+* @return The JSON object as a string
+*/
+std::string entityToJson(const GraphicDef& def);
+
+/*
+* @brief Converts the def of a physical entity to the JSON object saved in level files
+* 
+* @param def The def to convert
+* 
+* @return The JSON object as a string
+*/
+std::string entityToJson(const PhysicalDef& def);
\ No newline at end of file
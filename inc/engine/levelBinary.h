@@ -0,0 +1,178 @@
+#pragma once
+
+#include <engine/level.h>
+
+#include <util/mappedFile.h>
+
+// Binary level format
+//
+// A header followed by flat arrays of records. Records refer to each other with indices and strings
+// with offsets into the string table, so the file can be memory mapped and read in place.
+// Every section starts on a 4 byte boundary and all values are little-endian.
+
+// Current version of the binary level format (files with any other version are rejected)
+constexpr uint32_t BINARY_LEVEL_VERSION = 1;
+
+/*
+* @brief Header at the start of a binary level file
+*/
+struct BinaryLevelHeader
+{
+	// Always "B2LV"
+	char magic[4];
+
+	// Version of the format
+	uint32_t version;
+
+	// Total size of the file (used to detect truncated files)
+	uint32_t fileSize;
+
+	// Number of items in each section
+	uint32_t graphicCount;
+	uint32_t physicalCount;
+	uint32_t hitboxCount;
+	uint32_t vertexCount;
+	uint32_t stringBytes;
+
+	// Offset of each section from the start of the file
+	uint32_t graphicOffset;
+	uint32_t physicalOffset;
+	uint32_t hitboxOffset;
+	uint32_t vertexOffset;
+	uint32_t stringOffset;
+};
+
+/*
+* @brief Binary form of a GraphicDef
+*/
+struct BinaryGraphicRecord
+{
+	float sizeX, sizeY;
+	float positionX, positionY;
+
+	int32_t layer;
+	float depth;
+
+	// Texture name in the string table (length 0 for no texture)
+	uint32_t textureOffset;
+	uint32_t textureLength;
+};
+
+/*
+* @brief Binary form of a PhysicalDef
+*/
+struct BinaryPhysicalRecord
+{
+	BinaryGraphicRecord graphic;
+
+	uint32_t bodyType;
+
+	// Range of the hitboxes of the entity in the hitbox section
+	uint32_t firstHitbox;
+	uint32_t hitboxCount;
+};
+
+/*
+* @brief Binary form of a hitbox (range of vertices in the vertex section)
+*/
+struct BinaryHitboxRecord
+{
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+};
+
+/*
+* @brief Binary form of a vertex
+*/
+struct BinaryVertex
+{
+	float x, y;
+};
+
+/*
+* @brief A memory mapped binary level file that is read in place
+*/
+class BinaryLevel
+{
+	private:
+		// Mapping of the file
+		MappedFile file;
+
+		// Sections of the file (point straight into the mapping)
+		const BinaryLevelHeader* header = nullptr;
+		const BinaryGraphicRecord* graphics = nullptr;
+		const BinaryPhysicalRecord* physicals = nullptr;
+		const BinaryHitboxRecord* hitboxes = nullptr;
+		const BinaryVertex* vertices = nullptr;
+		const char* strings = nullptr;
+
+		/*
+		* @brief Fills in the GraphicDef part of a def from a record
+		*/
+		void readGraphic(const BinaryGraphicRecord& record, GraphicDef& def) const;
+
+	public:
+		/*
+		* @brief Maps a binary level file and checks that it is valid
+		*
+		* @param levelPath Path to the binary level file
+		*/
+		BinaryLevel(const std::string& levelPath);
+
+		/*
+		* @brief Gets the number of graphic entities in the level
+		*/
+		size_t getGraphicCount() const { return header->graphicCount; }
+
+		/*
+		* @brief Gets the number of physical entities in the level
+		*/
+		size_t getPhysicalCount() const { return header->physicalCount; }
+
+		/*
+		* @brief Reads the def of a graphic entity
+		*
+		* @param index Index of the entity
+		* @param def Def to fill in
+		*/
+		void getGraphicDef(size_t index, GraphicDef& def) const;
+
+		/*
+		* @brief Reads the def of a physical entity (reuses the memory of the def passed in)
+		*
+		* @param index Index of the entity
+		* @param def Def to fill in
+		*/
+		void getPhysicalDef(size_t index, PhysicalDef& def) const;
+};
+
+/*
+* @brief Checks if a file is a binary level (by its magic number)
+*
+* @param levelPath Path to the file
+*/
+bool isBinaryLevel(const std::string& levelPath);
+
+/*
+* @brief Loads a LevelDef from a binary level file
+*
+* @param levelPath Path to the binary level file
+*/
+LevelDef loadBinaryLevelDef(const std::string& levelPath);
+
+/*
+* @brief Loads a Level straight from a mapped binary level (without building a LevelDef)
+*
+* @param binaryLevel The mapped binary level
+*
+* @return Pointers to all the entities in the level
+*/
+Level loadLevel(const BinaryLevel& binaryLevel);
+
+/*
+* @brief Saves a LevelDef to a binary level file
+*
+* @param levelDef The LevelDef to save
+* @param levelPath Path of the binary level file
+*/
+void saveToBinary(const LevelDef& levelDef, const std::string& levelPath);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <engine/level.h>
+
+/*
+* @brief A level being loaded in the background. Created by Engine::loadLevelAsync
+* 
+* The file is read and parsed on a worker thread, then the entities are created on the main thread
+* a few at a time each frame (within LEVEL_LOAD_BUDGET_MS) so loading never stalls a frame. The bodies stay
+* disabled (and their entities do not update) until every entity has been created, then they are all enabled at once
+*/
+class LevelLoad
+{
+	private:
+		// Path of the level file
+		std::string levelPath;
+
+		// Def being parsed on the worker thread
+		std::future<LevelDef> parsing;
+
+		// Def once it has been parsed
+		LevelDef levelDef;
+
+		// Whether the worker thread has finished
+		bool parsed = false;
+
+		// Estimated memory of the def while it is held
+		TrackedMemory defMemory{ MemoryCategory::LEVEL_DEFS };
+
+		// Number of entities of each type that have been created
+		size_t createdGraphic = 0;
+		size_t createdPhysical = 0;
+
+		// Entities that have been created so far
+		Level level;
+
+		// Called once every entity has been created
+		std::function<void(Level&)> onComplete;
+
+		// Whether every entity has been created (or the load failed)
+		bool complete = false;
+
+		// Error parsing the file (empty if it did not fail)
+		std::string error;
+
+	public:
+		/*
+		* @brief Starts parsing a level file on a worker thread
+		* 
+		* @param levelPath The path to the JSON or binary level file
+		* @param onComplete Called on the main thread once every entity has been created (can be empty)
+		*/
+		LevelLoad(const std::string& levelPath, std::function<void(Level&)> onComplete);
+
+		/*
+		* @brief Creates as many entities as fit in the time budget. Must be called on the main thread
+		* 
+		* If parsing the file failed the error is kept (see getError), no entities are created and onComplete is
+		* not called
+		* 
+		* @param budgetMs Time that can be spent creating entities (at least one entity is always created)
+		* 
+		* @return Whether the level has finished loading or failed
+		*/
+		bool update(float budgetMs);
+
+		/*
+		* @brief Gets how much of the level has been created (0 while the file is being parsed, 1 when complete)
+		*/
+		float getProgress() const;
+
+		/*
+		* @brief Gets whether every entity has been created or the load failed
+		*/
+		bool isComplete() const { return complete; }
+
+		/*
+		* @brief Gets whether parsing the file failed
+		*/
+		bool failed() const { return !error.empty(); }
+
+		/*
+		* @brief Gets the error from parsing the file (empty if it did not fail)
+		*/
+		const std::string& getError() const { return error; }
+
+		/*
+		* @brief Gets the path of the level file
+		*/
+		const std::string& getPath() const { return levelPath; }
+
+		/*
+		* @brief Gets the entities that have been created so far
+		*/
+		Level& getLevel() { return level; }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <engine/level.h>
+
+/*
+* @brief Saves a level to a JSON file without blocking the frame
+* 
+* The JSON of each entity is cached with the revision it was made from, so a save only converts the
+* entities that changed since the last one. The file is written on a background thread to a temporary
+* file which then replaces the level file, so a crash never leaves a half written level behind
+*/
+class LevelSaver
+{
+	private:
+		/*
+		* @brief Cached JSON of an entity
+		*/
+		struct Fragment
+		{
+			// Revision of the entity the JSON was made from
+			uint64_t revision;
+
+			// JSON object of the entity (shared with any save still being written)
+			std::shared_ptr<const std::string> json;
+
+			// Number of the last save that used the fragment (used to drop entities that no longer exist)
+			size_t lastUsed;
+		};
+
+		/*
+		* @brief Everything needed to write a level file, taken when save is called
+		*/
+		struct SaveJob
+		{
+			std::string path;
+			std::vector<std::shared_ptr<const std::string>> graphicEntities;
+			std::vector<std::shared_ptr<const std::string>> physicalEntities;
+		};
+
+		// Cached JSON of each entity by its id
+		std::unordered_map<uint64_t, Fragment> fragments;
+
+		// Number of saves made
+		size_t saveCount = 0;
+
+		// Number of entities converted to JSON by the last save
+		size_t lastConverted = 0;
+
+		// Save being written on the background thread
+		std::future<void> writing;
+
+		// Latest save waiting for the current write to finish (older ones are replaced as they are out of date)
+		std::unique_ptr<SaveJob> queued;
+
+		/*
+		* @brief Gets the JSON of an entity, converting it only if it has changed
+		*/
+		template<typename ENTITY>
+		std::shared_ptr<const std::string> getFragment(ENTITY* entity);
+
+		/*
+		* @brief Starts writing a save on the background thread
+		*/
+		void startWriting(std::unique_ptr<SaveJob> job);
+
+		/*
+		* @brief Waits for the current write, starts the queued save then rethrows any error from the write
+		*/
+		void finishWriting();
+
+		/*
+		* @brief Writes a save to a temporary file and moves it over the level file
+		*/
+		static void write(const SaveJob& job);
+
+	public:
+		LevelSaver() = default;
+
+		LevelSaver(const LevelSaver&) = delete;
+		LevelSaver& operator=(const LevelSaver&) = delete;
+
+		/*
+		* @brief Waits for any saves that have not been written yet
+		*/
+		~LevelSaver();
+
+		/*
+		* @brief Saves a level. Only converts the entities that changed, the file is written in the background
+		* 
+		* @param level The level to save
+		* @param levelPath The path to the JSON file
+		*/
+		void save(const Level& level, const std::string& levelPath);
+
+		/*
+		* @brief Starts writing the queued save once the last one has finished. Call once per frame
+		* 
+		* Rethrows any error from writing the file
+		*/
+		void update();
+
+		/*
+		* @brief Blocks until every save has been written (call before closing)
+		* 
+		* Rethrows any error from writing the file
+		*/
+		void wait();
+
+		/*
+		* @brief Gets whether a save is being written or waiting to be written
+		*/
+		bool isSaving() const { return writing.valid() || queued != nullptr; }
+
+		/*
+		* @brief Gets the number of entities converted to JSON by the last save
+		*/
+		size_t getLastConvertedCount() const { return lastConverted; }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <engine/level.h>
+
+/*
+* @brief Number of entities each kind of change was applied to by the last reload
+*/
+struct LevelReloadStats
+{
+	size_t kept = 0;
+	size_t moved = 0;
+	size_t created = 0;
+	size_t removed = 0;
+};
+
+/*
+* @brief Loads a level and reloads it whenever its file changes on disk
+* 
+* Only the difference between the old and new file is applied: unchanged entities are kept as they are,
+* entities that only moved are teleported (keeping their b2Body) and only added or removed entities are
+* created or destroyed. Entities that changed in any other way are recreated.
+* 
+* Uses inotify on Linux and checks the modification time of the file on other platforms
+*/
+class LevelWatcher : public EngineSubClass
+{
+	private:
+		// Path of the level file
+		std::string levelPath;
+
+		// Def the entities were created from (the file as it was last read, in the same order as the level)
+		LevelDef levelDef;
+
+		// Entities of the level
+		Level level;
+
+		// What the last reload changed
+		LevelReloadStats lastReload;
+
+		// Number of times the level has been reloaded
+		size_t reloadCount = 0;
+
+		#ifdef __linux__
+		// inotify instance and the watch on the directory of the level (editors often replace files instead of writing them)
+		int inotifyDescriptor = -1;
+		int watchDescriptor = -1;
+		#else
+		// Modification time of the file when it was last read
+		std::filesystem::file_time_type lastWriteTime;
+
+		// When the modification time was last checked
+		std::chrono::steady_clock::time_point lastCheck;
+		#endif
+
+		/*
+		* @brief Checks if the file has changed since it was last read
+		*/
+		bool hasChanged();
+
+		/*
+		* @brief Reads the file again and applies the difference to the level
+		* 
+		* @return False if the file could not be read (the level is left as it was)
+		*/
+		bool reload();
+
+	public:
+		/*
+		* @brief Loads a level and starts watching its file
+		* 
+		* @param levelPath The path to the JSON or binary level file
+		*/
+		LevelWatcher(const std::string& levelPath);
+
+		LevelWatcher(const LevelWatcher&) = delete;
+		LevelWatcher& operator=(const LevelWatcher&) = delete;
+
+		/*
+		* @brief Stops watching the file. Does not remove the entities
+		*/
+		~LevelWatcher();
+
+		/*
+		* @brief Reloads the level if its file has changed. Call once per frame
+		* 
+		* @return Whether the level was reloaded
+		*/
+		bool update();
+
+		/*
+		* @brief Gets the entities of the level (the vectors change when the level is reloaded)
+		*/
+		Level& getLevel() { return level; }
+
+		/*
+		* @brief Gets what the last reload changed
+		*/
+		const LevelReloadStats& getLastReload() const { return lastReload; }
+
+		/*
+		* @brief Gets the number of times the level has been reloaded
+		*/
+		size_t getReloadCount() const { return reloadCount; }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief Summary of the recent values of a metric
+*/
+struct MetricSummary
+{
+	// Value of the last frame the metric was recorded in
+	double last = 0.0;
+
+	// Over the rolling window of recent frames
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+
+	// Number of frames in the window
+	size_t samples = 0;
+};
+
+/*
+* @brief Rolling window of the values of a metric over the last frames
+*/
+class MetricHistogram
+{
+	private:
+		// Ring of the recent values
+		std::vector<double> values;
+
+		// Where the next value goes and how many values the ring holds
+		size_t next = 0;
+		size_t count = 0;
+
+	public:
+		/*
+		* @param capacity Number of frames the window holds
+		*/
+		MetricHistogram(size_t capacity = METRICS_WINDOW) : values(std::max(capacity, (size_t)1)) {}
+
+		/*
+		* @brief Adds the value of a frame (replacing the oldest one once the window is full)
+		*/
+		void add(double value);
+
+		/*
+		* @brief Computes the mean, percentiles and maximum of the window
+		*/
+		MetricSummary summarise() const;
+};
+
+/*
+* @brief Collects named per-frame counters and timings and writes their rolling percentiles as JSON Lines
+*
+* Values are recorded during a frame with set (or add for counters) and committed to their histograms by endFrame.
+* Every few frames one line with a summary of each metric is written to a file and / or a local UNIX socket,
+* for dashboards to tail. Recording is thread safe so controllers updating on the job system can record too.
+*/
+class MetricsRegistry
+{
+	private:
+		/*
+		* @brief A metric and its history
+		*/
+		struct Metric
+		{
+			std::string name;
+
+			// Value recorded this frame
+			double value = 0.0;
+			bool recorded = false;
+
+			// Values of the recent frames
+			MetricHistogram history;
+
+			// Value of the last frame it was recorded in
+			double last = 0.0;
+		};
+
+		// Every metric in the order they were first recorded (the order they are written in)
+		std::vector<Metric> metrics;
+
+		// Index of each metric by name
+		std::unordered_map<std::string, size_t> indices;
+
+		// Guards the metrics
+		mutable std::mutex mutex;
+
+		// Frames committed so far
+		size_t frame = 0;
+
+		// Frames between each line written
+		size_t writeInterval = METRICS_WRITE_INTERVAL;
+
+		// File the lines are appended to (if open)
+		std::ofstream file;
+
+		// Socket the lines are sent to (-1 when not connected) and the path it connects to
+		int socketHandle = -1;
+		std::string socketPath;
+
+		// Lines waiting for the socket to accept them (only whole lines are ever dropped)
+		std::string socketBacklog;
+
+		// When the socket last tried to connect (it reconnects at most once a second)
+		std::chrono::steady_clock::time_point lastConnectAttempt;
+
+		// Lines that could not be sent because the reader was too slow or gone
+		size_t droppedLines = 0;
+
+		/*
+		* @brief Writes a line to the file and the socket
+		*/
+		void writeLine(const std::string& line);
+
+		/*
+		* @brief Connects the socket to socketPath
+		*
+		* @return Whether it connected
+		*/
+		bool connectSocket();
+
+		/*
+		* @brief Closes the socket (it is reconnected by the next line written)
+		*/
+		void disconnectSocket();
+
+		/*
+		* @brief Builds the line of the current frame (the mutex must be held)
+		*/
+		nl::json buildLine() const;
+
+	public:
+		MetricsRegistry() = default;
+
+		MetricsRegistry(const MetricsRegistry&) = delete;
+		MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+		~MetricsRegistry();
+
+		/*
+		* @brief Gets the index of a metric, creating it if it does not exist (indices can be kept to skip the lookup)
+		*/
+		size_t getIndex(const std::string& name);
+
+		/*
+		* @brief Sets the value of a metric for this frame
+		*/
+		void set(size_t index, double value);
+		void set(const std::string& name, double value) { set(getIndex(name), value); }
+
+		/*
+		* @brief Adds to the value of a metric for this frame (for counting events)
+		*/
+		void add(size_t index, double amount);
+		void add(const std::string& name, double amount) { add(getIndex(name), amount); }
+
+		/*
+		* @brief Commits the values of this frame to the histograms and writes a line if one is due
+		*
+		* Metrics that were not recorded this frame keep their history unchanged
+		*/
+		void endFrame();
+
+		/*
+		* @brief Gets the summary of a metric (all zeros if it has never been recorded)
+		*/
+		MetricSummary getSummary(const std::string& name) const;
+
+		/*
+		* @brief Gets the line that would be written now (the summary of every metric)
+		*/
+		std::string toJson() const;
+
+		/*
+		* @brief Appends the lines to a file
+		*
+		* @param path Path of the file (created if it does not exist)
+		*/
+		void openFile(const std::string& path);
+
+		/*
+		* @brief Sends the lines to a local UNIX stream socket (not supported on Windows)
+		*
+		* The reader can start after the engine and restart at any time. Lines are dropped rather than blocking
+		* the frame while nothing is reading.
+		*
+		* @param path Path of the socket
+		*/
+		void openSocket(const std::string& path);
+
+		/*
+		* @brief Stops writing lines to the file and the socket
+		*/
+		void closeOutput();
+
+		/*
+		* @brief Sets the number of frames between each line written (at least 1)
+		*/
+		void setWriteInterval(size_t frames) { writeInterval = std::max(frames, (size_t)1); }
+
+		/*
+		* @brief Gets the number of lines the socket dropped
+		*/
+		size_t getDroppedLines() const;
+};
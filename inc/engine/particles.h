@@ -0,0 +1,246 @@
+#pragma once
+
+#include <engine/base.h>
+
+#include <util/util.h>
+
+/*
+* @brief Description of the particles an emitter (or a burst) creates
+*/
+struct ParticleEmitterDef
+{
+	// Centre of the emitter (meters)
+	Vec2 position;
+
+	// Half the size of the box particles start in around the position (meters)
+	Vec2 area;
+
+	// Particles created each second (0 for an emitter only used for bursts)
+	float rate = 100.0f;
+
+	// Seconds a particle lives, plus or minus up to the variance
+	float lifetime = 1.0f;
+	float lifetimeVariance = 0.0f;
+
+	// Starting velocity (meters per second). Its direction is turned by up to half the spread either way
+	Vec2 velocity = Vec2(0.0f, -5.0f);
+
+	// Angle the directions of the particles are spread over (radians)
+	float spread = 0.5f;
+
+	// Fraction the starting speed varies by (0.25 gives speeds from 75% to 125% of the velocity's)
+	float speedVariance = 0.25f;
+
+	// Downwards acceleration of the particles (meters per second squared, negative to rise)
+	float gravity = 9.8f;
+
+	// Side of the square drawn for each particle (meters)
+	float size = 0.1f;
+
+	// Colour at the start and end of a particle's life (blended linearly)
+	sf::Color startColor = sf::Color::White;
+	sf::Color endColor = sf::Color(255, 255, 255, 0);
+
+	// Whether the particles bounce off static bodies
+	bool collide = false;
+
+	// Fraction of the speed into a surface kept when bouncing
+	float restitution = 0.3f;
+};
+
+/*
+* @brief Simulates and draws large numbers of short lived particles
+*
+* Every property of the particles is kept in its own array (structure of arrays) so the integration goes through
+* contiguous floats four at a time with SSE2. Particles never touch the b2World other than colliding particles which
+* raycast against static fixtures, each one only every PARTICLE_COLLISION_INTERVAL steps looking that many steps
+* ahead. Dead particles are replaced by the last one so the arrays stay packed. Every particle is drawn as a square
+* in one vertex array, which is one draw call.
+*
+* Updates alongside the other systems (reading the world, writing RESOURCE_PARTICLES), so systems that add emitters
+* or bursts in their update should declare they write RESOURCE_PARTICLES.
+*/
+class ParticleSystem : public EngineController
+{
+	private:
+		/*
+		* @brief Properties of a particle, each one an array
+		*/
+		enum Field
+		{
+			POSITION_X,
+			POSITION_Y,
+			VELOCITY_X,
+			VELOCITY_Y,
+			GRAVITY,
+			LIFE,
+			SIZE,
+			RED,
+			GREEN,
+			BLUE,
+			ALPHA,
+			RED_RATE,
+			GREEN_RATE,
+			BLUE_RATE,
+			ALPHA_RATE,
+
+			// Negative for particles which do not collide
+			RESTITUTION,
+
+			FIELD_COUNT
+		};
+
+		/*
+		* @brief An emitter and the particles it still owes
+		*/
+		struct Emitter
+		{
+			ParticleEmitterDef def;
+
+			// Fraction of a particle carried over to the next step
+			float accumulator = 0.0f;
+
+			// Whether the slot is in use (removed slots are reused)
+			bool active = false;
+		};
+
+		using ParticleArray = std::vector<float, TrackingAllocator<float, MemoryCategory::PARTICLES>>;
+
+		// One array per field, all the same size (the capacity)
+		std::array<ParticleArray, FIELD_COUNT> fields;
+
+		// Number of particles alive (the first count elements of every field)
+		size_t count = 0;
+
+		// Emitters, indexed by their id
+		std::vector<Emitter> emitters;
+
+		// Vertices of every particle on screen (kept until the frame is drawn)
+		sf::VertexArray vertices;
+
+		// Number of particles inside the view in the last render
+		size_t drawnCount = 0;
+
+		// Layer the particles are drawn on
+		int layer = 1;
+
+		// Number of updates so far (picks which particles raycast this step)
+		size_t step = 0;
+
+		// State of the random number generator (xorshift)
+		uint32_t randomState = 0x9E3779B9u;
+
+		/*
+		* @brief Gets a random number from 0 to 1
+		*/
+		float random();
+
+		/*
+		* @brief Gets a random number from -1 to 1
+		*/
+		float randomSigned() { return random() * 2.0f - 1.0f; }
+
+		/*
+		* @brief Grows the arrays so they hold at least the given number of particles (up to MAX_PARTICLES)
+		*/
+		void reserve(size_t needed);
+
+		/*
+		* @brief Creates particles from a def
+		*
+		* @param def Description of the particles
+		* @param amount Number of particles to create (fewer once MAX_PARTICLES is reached)
+		*/
+		void spawn(const ParticleEmitterDef& def, size_t amount);
+
+		/*
+		* @brief Moves the particles, ages them and blends their colour
+		*/
+		void integrate(float dt);
+
+		/*
+		* @brief Bounces the colliding particles whose turn it is off the static fixtures ahead of them
+		*/
+		void collide(float dt);
+
+		/*
+		* @brief Removes the particles with no life left
+		*/
+		void removeDead();
+
+	public:
+		/*
+		* @brief Creates an empty particle system (the arrays grow as particles are created)
+		*/
+		ParticleSystem();
+
+		/*
+		* @brief Adds an emitter which creates particles every update
+		*
+		* @param def Description of the emitter
+		*
+		* @return Id of the emitter
+		*/
+		size_t addEmitter(const ParticleEmitterDef& def);
+
+		/*
+		* @brief Removes an emitter (its particles live out their lifetime)
+		*/
+		void removeEmitter(size_t id);
+
+		/*
+		* @brief Gets the description of an emitter to change it
+		*/
+		ParticleEmitterDef& getEmitter(size_t id);
+
+		/*
+		* @brief Moves an emitter
+		*
+		* @param id Id of the emitter
+		* @param position New centre of the emitter (meters)
+		*/
+		void setEmitterPosition(size_t id, Vec2 position) { getEmitter(id).position = position; }
+
+		/*
+		* @brief Creates a number of particles at once at the def's position
+		*
+		* @param def Description of the particles (its rate is ignored)
+		* @param amount Number of particles
+		*/
+		void emit(const ParticleEmitterDef& def, size_t amount);
+
+		/*
+		* @brief Removes every particle (keeps the emitters)
+		*/
+		void clear();
+
+		/*
+		* @brief Gets the number of particles alive
+		*/
+		size_t getCount() const { return count; }
+
+		/*
+		* @brief Gets the number of particles drawn in the last render (the ones inside the view)
+		*/
+		size_t getDrawnCount() const { return drawnCount; }
+
+		/*
+		* @brief Sets the layer the particles are drawn on (1 by default, above entities)
+		*/
+		void setLayer(int newLayer) { layer = newLayer; }
+
+		/*
+		* @brief Emits, moves, collides and removes the particles
+		*/
+		void update() override;
+
+		/*
+		* @brief Records the particles inside the view as one vertex array
+		*/
+		void render() override;
+
+		/*
+		* @brief Reads the world for collisions and writes only the particles, off the main thread
+		*/
+		SystemAccess getAccess() const override;
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <engine/commandBuffer.h>
+
+#include <util/util.h>
+
+/*
+* @brief Executes the command buffers of a frame sorted by layer, render state and depth
+* 
+* Consecutive quads and lines that share render states are batched into a single draw call
+* and quads / lines outside of the view are culled
+* 
+* Within a layer commands are grouped by shader then texture before depth, so depth only orders commands that share
+* the same render state. Commands that must be drawn in a strict order with different states need different layers
+*/
+class RenderQueue
+{
+	private:
+		/*
+		* @brief Reference to a command that is actually sorted (much smaller to move around than a RenderCommand)
+		*/
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t buffer;
+			uint32_t command;
+		};
+
+		// Buffer the main thread records into
+		CommandBuffer mainBuffer;
+
+		// Buffers submitted from other threads this frame
+		std::vector<CommandBuffer> submittedBuffers;
+
+		// Guards submittedBuffers
+		std::mutex submitMutex;
+
+		// Sort buffers (kept between frames to avoid allocating)
+		std::vector<SortEntry> entries;
+		std::vector<SortEntry> scratch;
+
+		// Vertices of the batch being built
+		std::vector<sf::Vertex> batchVertices;
+
+		// Small ids given to the shaders and textures used this frame
+		std::unordered_map<const void*, uint32_t> stateIds;
+
+		// Statistics of the last flush
+		size_t drawCount = 0;
+		size_t culledCount = 0;
+		size_t vertexCount = 0;
+		size_t shaderDrawCount = 0;
+
+		/*
+		* @brief Gets the id of a shader or texture (0 for none)
+		*/
+		uint32_t getStateId(const void* state);
+
+		/*
+		* @brief Draws the batch being built and empties it
+		*/
+		void drawBatch(sf::RenderTarget& target, sf::PrimitiveType type, const sf::RenderStates& states);
+
+	public:
+		// Lowest and highest layers that can be used
+		static constexpr int MIN_LAYER = -128;
+		static constexpr int MAX_LAYER = 127;
+
+		// Layer debug drawing (such as hitboxes) is drawn on so it is always on top
+		static constexpr int DEBUG_LAYER = MAX_LAYER;
+
+		/*
+		* @brief Builds the sort key of a command
+		* 
+		* @param layer Layer of the command (clamped to MIN_LAYER - MAX_LAYER)
+		* @param shaderId Id of the shader it is drawn with
+		* @param textureId Id of the texture it is drawn with
+		* @param depth Depth of the command among the commands with the same layer, shader and texture (lower is drawn first)
+		*/
+		static uint64_t makeKey(int layer, uint32_t shaderId, uint32_t textureId, float depth);
+
+		/*
+		* @brief Gets the buffer the main thread records into
+		*/
+		CommandBuffer& getMainBuffer() { return mainBuffer; }
+
+		/*
+		* @brief Adds a buffer recorded on another thread to this frame (thread safe)
+		* 
+		* @param buffer Recorded buffer
+		*/
+		void submit(CommandBuffer&& buffer);
+
+		/*
+		* @brief Sorts, batches and draws every command recorded this frame and then empties the buffers
+		* 
+		* @param target Target everything is drawn to
+		*/
+		void flush(sf::RenderTarget& target);
+
+		/*
+		* @brief Gets the number of draw calls made by the last flush
+		*/
+		size_t getDrawCount() const { return drawCount; }
+
+		/*
+		* @brief Gets the number of commands culled by the last flush
+		*/
+		size_t getCulledCount() const { return culledCount; }
+
+		/*
+		* @brief Gets the number of batched vertices drawn by the last flush
+		*/
+		size_t getVertexCount() const { return vertexCount; }
+
+		/*
+		* @brief Gets the number of draw calls made with a shader by the last flush
+		*/
+		size_t getShaderDrawCount() const { return shaderDrawCount; }
+};
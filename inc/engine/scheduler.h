@@ -0,0 +1,117 @@
+#pragma once
+
+#include <engine/jobs.h>
+
+#include <util/util.h>
+
+class EngineController;
+
+/*
+* @brief Data a system can read or write (combined into bitmasks)
+*/
+enum SystemResource : uint64_t
+{
+	RESOURCE_ENTITIES = 1ull << 0,	// Entity::instances and the entities themselves
+	RESOURCE_WORLD = 1ull << 1,		// The b2World and every body in it
+	RESOURCE_VIEW = 1ull << 2,		// The view of the render texture
+	RESOURCE_INPUT = 1ull << 3,		// Input state and the window
+	RESOURCE_LEVEL = 1ull << 4,		// Levels, prefabs and the shape cache
+	RESOURCE_AUDIO = 1ull << 5,
+	RESOURCE_PARTICLES = 1ull << 6,
+	RESOURCE_AI = 1ull << 7,
+
+	// First bit free for resources of the game itself
+	RESOURCE_USER = 1ull << 16,
+
+	RESOURCE_ALL = ~0ull
+};
+
+/*
+* @brief What a system reads and writes during its update
+*
+* Two systems can update at the same time when neither writes anything the other reads or writes.
+*/
+struct SystemAccess
+{
+	// Bitmasks of SystemResource
+	uint64_t reads = RESOURCE_ALL;
+	uint64_t writes = RESOURCE_ALL;
+
+	// Whether the update must run on the thread that called Engine::update (SFML and OpenGL calls for example)
+	bool mainThread = true;
+
+	/*
+	* @brief Checks if two systems can update at the same time
+	*/
+	bool conflictsWith(const SystemAccess& other) const
+	{
+		return (writes & (other.reads | other.writes)) != 0 || (other.writes & reads) != 0;
+	}
+};
+
+/*
+* @brief Runs the updates of the systems (controllers) of the engine, in parallel where their access allows
+*
+* The systems are split into waves once whenever the list of systems changes. A system goes in the wave after the
+* last one holding an earlier system it conflicts with, so conflicting systems always update in the order they
+* were added. The systems of a wave update on the job system and the wave is waited for before the next one starts.
+*/
+class SystemScheduler
+{
+	private:
+		/*
+		* @brief A system and its access (read once, when it is added)
+		*/
+		struct System
+		{
+			EngineController* controller;
+			SystemAccess access;
+		};
+
+		// Systems in the order they were added
+		std::vector<System> systems;
+
+		// Indices of the systems in each wave
+		std::vector<std::vector<size_t>> waves;
+
+		// Whether the waves need building again
+		bool wavesDirty = true;
+
+		/*
+		* @brief Splits the systems into waves
+		*/
+		void buildWaves();
+
+	public:
+		/*
+		* @brief Adds a system (the scheduler does not own it)
+		*/
+		void add(EngineController* controller);
+
+		/*
+		* @brief Removes a system
+		*/
+		void remove(EngineController* controller);
+
+		/*
+		* @brief Updates every system
+		*
+		* @param jobs Job system the systems of each wave update on
+		*/
+		void update(JobSystem& jobs);
+
+		/*
+		* @brief Calls a function on every system in the order they were added (used for init, render and close)
+		*/
+		void forEach(const std::function<void(EngineController&)>& function);
+
+		/*
+		* @brief Gets the number of waves the systems are split into (1 when all of them can update at once)
+		*/
+		size_t getWaveCount();
+
+		/*
+		* @brief Gets the number of systems
+		*/
+		size_t size() const { return systems.size(); }
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <engine/decomposition.h>
+
+#include <util/util.h>
+
+/*
+* @brief A hitbox as it was written in its def and the convex shapes it was split into
+*/
+struct Hitbox
+{
+	// Outline from the def (what createDefOf gives back)
+	std::vector<Vec2> outline;
+
+	// Convex pieces a fixture is made for
+	std::vector<std::shared_ptr<b2PolygonShape>> pieces;
+};
+
+/*
+* @brief Cache of polygon shapes keyed by their vertices so entities with the same hitbox share one shape
+* 
+* b2PolygonShape::Set computes the convex hull and centroid, which is only done once per distinct vertex list.
+* Shapes are also stored under the vertices of their hull (what createDefOf returns) so round trips through
+* defs find the same shape. Concave outlines and outlines with too many vertices are split into convex pieces
+* first (the split is cached on disk). Shapes in the cache must not be modified
+*/
+class ShapeCache
+{
+	private:
+		// Shapes keyed by the bytes of their vertices
+		std::unordered_map<std::string, std::shared_ptr<b2PolygonShape>> shapes;
+
+		// Hitboxes keyed by the bytes of their outline
+		std::unordered_map<std::string, std::shared_ptr<const Hitbox>> hitboxes;
+
+		// Splits of the outlines that are not convex
+		DecompositionCache decompositions;
+
+		// Number of lookups that found a shape
+		size_t hits = 0;
+
+		// Number of lookups that had to create a shape
+		size_t misses = 0;
+
+		/*
+		* @brief Gets the key of a vertex list
+		*/
+		static std::string makeKey(const Vec2* vertices, size_t count);
+
+	public:
+		/*
+		* @brief Creates the cache
+		* 
+		* @param decompositionDirectory Directory convex decompositions are cached in (empty to not cache them on disk)
+		*/
+		ShapeCache(const std::string& decompositionDirectory = "") : decompositions(decompositionDirectory) {}
+
+		/*
+		* @brief Gets the hitbox with the given outline, splitting it into convex shapes if it is not in the cache
+		* 
+		* @param outline Outline of the hitbox relative to the body (any simple polygon)
+		* 
+		* @return The shared hitbox
+		*/
+		std::shared_ptr<const Hitbox> getHitbox(const std::vector<Vec2>& outline);
+
+		/*
+		* @brief Gets the shape with the given vertices, creating it if it is not in the cache
+		* 
+		* @param vertices Vertices of a convex polygon with at most b2_maxPolygonVertices vertices relative to the body
+		* 
+		* @return The shared shape
+		*/
+		std::shared_ptr<b2PolygonShape> get(const std::vector<Vec2>& vertices);
+
+		/*
+		* @brief Removes hitboxes and shapes that are not used by any entity
+		*/
+		void releaseUnused();
+
+		/*
+		* @brief Gets the number of keys in the cache (a shape can be stored under two keys)
+		*/
+		size_t size() const { return shapes.size(); }
+
+		/*
+		* @brief Gets the number of lookups that found a shape
+		*/
+		size_t getHitCount() const { return hits; }
+
+		/*
+		* @brief Gets the number of lookups that had to create a shape
+		*/
+		size_t getMissCount() const { return misses; }
+
+		/*
+		* @brief Gets the cache of convex decompositions
+		*/
+		const DecompositionCache& getDecompositions() const { return decompositions; }
+};
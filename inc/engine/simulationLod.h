@@ -0,0 +1,88 @@
+#pragma once
+
+#include <util/util.h>
+
+/*
+* @brief How often the body of an entity is simulated
+*/
+enum class SimulationTier : uint8_t
+{
+	FULL,		// Every step
+	REDUCED,	// Every few steps, asleep in between (keeps its fixtures and contacts)
+	FROZEN		// Never, the body is disabled (no fixtures or contacts) until it comes close again
+};
+
+/*
+* @brief Settings of the simulation level of detail
+*/
+struct SimulationLODSettings
+{
+	// Whether bodies far from the view are simulated less
+	bool enabled = SIMULATION_LOD_ENABLED;
+
+	// Dynamic bodies further than this from the centre of the view are only stepped every few steps (meters)
+	float reducedRadius = SIMULATION_REDUCED_RADIUS;
+
+	// Dynamic bodies further than this from the centre of the view are disabled (meters)
+	float frozenRadius = SIMULATION_FROZEN_RADIUS;
+
+	// Extra distance a body has to move out past a radius before it drops a tier (so bodies on the edge do not flicker)
+	float hysteresis = SIMULATION_LOD_HYSTERESIS;
+
+	// Steps between each step of a reduced body
+	unsigned int reducedInterval = SIMULATION_REDUCED_INTERVAL;
+};
+
+/*
+* @brief Simulates dynamic bodies far from the view less often, or not at all
+*
+* Runs before the entities' pre step updates. A reduced body is put to sleep on the steps it misses and its entity's
+* pre and post step updates are skipped, so its velocity and custom gravity are kept by the entity and put back on the
+* body by preStepUpdate the next time it steps (its simulation runs slower than real time while it is far away).
+* Reduced bodies all step on the same steps so touching ones do not wake each other. A frozen body is disabled,
+* which ends its contacts through the contact listener so the contact maps of both bodies stay correct, and is
+* enabled again with its entity's velocity when it comes close. Static and kinematic bodies are never touched.
+*/
+class SimulationLOD
+{
+	private:
+		SimulationLODSettings settings;
+
+		// Number of bodies in each tier after the last update
+		std::array<size_t, 3> tierCounts = {};
+
+		/*
+		* @brief Picks the tier of a body from its distance to the view (with hysteresis against its current tier)
+		*/
+		SimulationTier chooseTier(float distance, SimulationTier current) const;
+
+	public:
+		/*
+		* @brief Moves every dynamic body into the tier for its distance and marks the entities that skip this step
+		*
+		* @param focus Centre of the view (meters)
+		* @param intervalScale Multiplies the reduced interval (the governor raises it when frames are over budget)
+		* @param step Number of the step about to be taken (reduced bodies step when it is a multiple of the interval)
+		*/
+		void update(Vec2 focus, unsigned int intervalScale, size_t step);
+
+		/*
+		* @brief Puts every body back to full simulation (used when the LOD is turned off)
+		*/
+		void restoreAll();
+
+		/*
+		* @brief Changes the settings (bodies move to their new tiers on the next update)
+		*/
+		void setSettings(const SimulationLODSettings& newSettings);
+
+		/*
+		* @brief Gets the settings
+		*/
+		const SimulationLODSettings& getSettings() const { return settings; }
+
+		/*
+		* @brief Gets the number of bodies in a tier after the last update
+		*/
+		size_t getCount(SimulationTier tier) const { return tierCounts[(size_t)tier]; }
+};
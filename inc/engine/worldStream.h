@@ -0,0 +1,143 @@
+#pragma once
+
+#include <engine/levelBinary.h>
+#include <engine/level.h>
+
+#include <util/util.h>
+
+/*
+* @brief Coordinate of a chunk in a streamed world
+*/
+struct ChunkCoord
+{
+	int x, y;
+
+	bool operator==(const ChunkCoord& other) const { return x == other.x && y == other.y; }
+};
+
+/*
+* @brief Hash function for ChunkCoord so it can be used as a map key
+*/
+struct ChunkCoordHash
+{
+	size_t operator()(const ChunkCoord& coord) const
+	{
+		return std::hash<uint64_t>()(((uint64_t)(uint32_t)coord.x << 32) | (uint64_t)(uint32_t)coord.y);
+	}
+};
+
+/*
+* @brief Splits a level into chunk files so it can be streamed
+* 
+* Each entity goes into the chunk its position is in. Writes a binary level per chunk and a chunks.json index
+* 
+* @param levelDef The level to split
+* @param directory Directory the chunks are written to
+* @param chunkSize Width and height of each chunk in meters
+*/
+void splitLevelIntoChunks(const LevelDef& levelDef, const std::string& directory, float chunkSize);
+
+/*
+* @brief A level split into chunks where only the chunks near the view exist in the b2World
+* 
+* Chunks are parsed on a background thread when the view gets close to them and saved back
+* (with their bodies destroyed) when it moves away, so the body count stays bounded
+*/
+class StreamedWorld : public EngineSubClass
+{
+	private:
+		/*
+		* @brief A chunk being written back on a background thread
+		*/
+		struct ChunkSave
+		{
+			// Def being written (kept until the write succeeds so the chunk is not lost if it fails)
+			std::shared_ptr<const LevelDef> def;
+
+			std::future<void> writing;
+		};
+
+		// Directory the chunk files are in
+		std::string directory;
+
+		// Size of each chunk in meters
+		float chunkSize = 0.0f;
+
+		// Chunks closer than this to the centre of the view are loaded (meters)
+		float loadRadius;
+
+		// Chunks further than this from the centre of the view are unloaded (meters, larger than loadRadius so chunks on the edge do not flicker)
+		float unloadRadius;
+
+		// Every chunk that has a file
+		std::unordered_set<ChunkCoord, ChunkCoordHash> chunkFiles;
+
+		// Chunks whose entities currently exist
+		std::unordered_map<ChunkCoord, Level, ChunkCoordHash> loadedChunks;
+
+		// Chunks being parsed on a background thread
+		std::unordered_map<ChunkCoord, std::future<LevelDef>, ChunkCoordHash> loadingChunks;
+
+		// Chunks being written back on a background thread
+		std::unordered_map<ChunkCoord, ChunkSave, ChunkCoordHash> savingChunks;
+
+		// Chunks whose write failed, kept in memory (loaded from here instead of their file and written again on close)
+		std::unordered_map<ChunkCoord, std::shared_ptr<const LevelDef>, ChunkCoordHash> unsavedChunks;
+
+		/*
+		* @brief Gets the path of the file of a chunk
+		*/
+		std::string getChunkPath(ChunkCoord coord) const;
+
+		/*
+		* @brief Gets the distance from a point to the closest point of a chunk
+		*/
+		float distanceToChunk(ChunkCoord coord, Vec2 point) const;
+
+		/*
+		* @brief Saves a chunk on a background thread and removes its entities
+		*/
+		void unloadChunk(ChunkCoord coord);
+
+		/*
+		* @brief Gets the result of a finished write, keeping the def as unsaved if it failed
+		*/
+		void finishSave(ChunkCoord coord, ChunkSave& save);
+
+	public:
+		/*
+		* @brief Opens a directory written by splitLevelIntoChunks
+		* 
+		* @param directory Directory of the chunks
+		* @param loadRadius Chunks closer than this to the centre of the view are loaded (meters)
+		* @param unloadRadius Chunks further than this from the centre of the view are unloaded (meters)
+		*/
+		StreamedWorld(const std::string& directory, float loadRadius, float unloadRadius);
+
+		/*
+		* @brief Waits for any background work to finish. Does not touch the entities as the engine may have already removed them
+		*/
+		~StreamedWorld();
+
+		/*
+		* @brief Loads and unloads chunks around the centre of the engine's view. Call once per frame
+		*/
+		void update();
+
+		/*
+		* @brief Renders every loaded entity
+		*/
+		void render();
+
+		/*
+		* @brief Saves every loaded chunk and removes its entities (blocks until written). Call before the engine closes
+		* 
+		* Chunks that still fail to be written are reported and lost
+		*/
+		void close();
+
+		/*
+		* @brief Gets the chunks whose entities currently exist
+		*/
+		const std::unordered_map<ChunkCoord, Level, ChunkCoordHash>& getLoadedChunks() const { return loadedChunks; }
+};
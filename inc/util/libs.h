@@ -22,11 +22,23 @@ namespace nl = nlohmann;
 
 // Standard Libraries
 
+#include <condition_variable>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <cstdint>
 #include <fstream>
+#include <atomic>
+#include <future>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <string>
+#include <thread>
+#include <deque>
+#include <array>
+#include <mutex>
 #include <cmath>
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <util/libs.h>
+
+/*
+* @brief Read only memory mapping of a whole file
+*/
+class MappedFile
+{
+	private:
+		// Start of the mapped memory (nullptr for an empty file)
+		const uint8_t* data = nullptr;
+
+		// Size of the file in bytes
+		size_t size = 0;
+
+		// OS handles of the file and mapping
+		#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+		#else
+		int fileDescriptor = -1;
+		#endif
+
+		/*
+		* @brief Unmaps the file and closes the handles
+		*/
+		void close();
+
+	public:
+		/*
+		* @brief Maps a file into memory
+		* 
+		* @param path Path of the file
+		*/
+		MappedFile(const std::string& path);
+
+		/*
+		* @brief Unmaps the file
+		*/
+		~MappedFile();
+
+		// Mappings can not be copied
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/*
+		* @brief Gets the start of the file in memory
+		*/
+		const uint8_t* getData() const { return data; }
+
+		/*
+		* @brief Gets the size of the file in bytes
+		*/
+		size_t getSize() const { return size; }
+};
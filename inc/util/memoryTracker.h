@@ -0,0 +1,214 @@
+#pragma once
+
+#include <util/libs.h>
+
+/*
+* @brief Subsystems memory is accounted to
+*/
+enum class MemoryCategory
+{
+	ENTITIES,			// Entity objects
+	USER_DATA,			// B2CustomUserData and its contact maps
+	BOX2D,				// Everything Box2D allocates (needs B2_USER_SETTINGS, see b2_user_settings.h)
+	SHAPES,				// Cached hitbox shapes
+	RENDER_TEXTURES,	// Render targets (estimated from their size)
+	LEVEL_DEFS,			// Level defs held while loading (estimated)
+	ASSETS,				// Decoded images and textures (estimated from their size)
+	PARTICLES,			// Particle arrays
+
+	COUNT
+};
+
+/*
+* @brief Memory use of one category
+*/
+struct MemoryStats
+{
+	// Bytes in use now and the most that have been in use at once
+	size_t currentBytes = 0;
+	size_t peakBytes = 0;
+
+	// Allocations made since the start and during the last frame
+	size_t totalAllocations = 0;
+	size_t frameAllocations = 0;
+};
+
+/*
+* @brief Counts the memory each subsystem allocates (thread safe)
+*
+* Used to find the systems that allocate every frame in steady state
+*/
+class MemoryTracker
+{
+	private:
+		/*
+		* @brief Counters of one category
+		*/
+		struct Counters
+		{
+			std::atomic<size_t> currentBytes{ 0 };
+			std::atomic<size_t> peakBytes{ 0 };
+			std::atomic<size_t> totalAllocations{ 0 };
+			std::atomic<size_t> frameAllocations{ 0 };
+
+			// Allocations of the last frame that finished
+			std::atomic<size_t> lastFrameAllocations{ 0 };
+		};
+
+		static std::array<Counters, (size_t)MemoryCategory::COUNT> counters;
+
+		// Whether Box2D has called the allocation hooks (false if Box2D was built without B2_USER_SETTINGS)
+		static std::atomic<bool> box2DHooked;
+
+	public:
+		/*
+		* @brief Records an allocation
+		*/
+		static void allocated(MemoryCategory category, size_t bytes);
+
+		/*
+		* @brief Records memory being freed
+		*/
+		static void freed(MemoryCategory category, size_t bytes);
+
+		/*
+		* @brief Starts counting the allocations of a new frame
+		*/
+		static void endFrame();
+
+		/*
+		* @brief Gets the memory use of a category
+		*/
+		static MemoryStats getStats(MemoryCategory category);
+
+		/*
+		* @brief Gets the display name of a category
+		*/
+		static const char* getName(MemoryCategory category);
+
+		/*
+		* @brief Writes the memory use of every category as a table
+		*/
+		static void dump(std::ostream& stream);
+
+		/*
+		* @brief Allocates memory for Box2D (called by b2Alloc when Box2D is built with B2_USER_SETTINGS)
+		*/
+		static void* box2DAlloc(size_t bytes);
+
+		/*
+		* @brief Frees memory allocated by box2DAlloc
+		*/
+		static void box2DFree(void* memory);
+
+		/*
+		* @brief Checks if Box2D allocates through the tracker
+		*/
+		static bool isBox2DHooked() { return box2DHooked; }
+};
+
+/*
+* @brief Standard library allocator that accounts everything it allocates to a category
+*/
+template<typename T, MemoryCategory CATEGORY>
+struct TrackingAllocator
+{
+	using value_type = T;
+
+	template<typename OTHER>
+	struct rebind { using other = TrackingAllocator<OTHER, CATEGORY>; };
+
+	TrackingAllocator() noexcept = default;
+
+	template<typename OTHER>
+	TrackingAllocator(const TrackingAllocator<OTHER, CATEGORY>&) noexcept {}
+
+	T* allocate(size_t count)
+	{
+		MemoryTracker::allocated(CATEGORY, count * sizeof(T));
+		return static_cast<T*>(::operator new(count * sizeof(T)));
+	}
+
+	void deallocate(T* memory, size_t count) noexcept
+	{
+		MemoryTracker::freed(CATEGORY, count * sizeof(T));
+		::operator delete(memory);
+	}
+
+	template<typename OTHER>
+	bool operator==(const TrackingAllocator<OTHER, CATEGORY>&) const noexcept { return true; }
+
+	template<typename OTHER>
+	bool operator!=(const TrackingAllocator<OTHER, CATEGORY>&) const noexcept { return false; }
+};
+
+/*
+* @brief Memory accounted to a category for as long as the object exists (for memory not allocated through the tracker, like GPU textures)
+*/
+class TrackedMemory
+{
+	private:
+		MemoryCategory category;
+		size_t bytes = 0;
+
+	public:
+		TrackedMemory(MemoryCategory category, size_t bytes = 0) : category(category) { set(bytes); }
+
+		TrackedMemory(const TrackedMemory&) = delete;
+		TrackedMemory& operator=(const TrackedMemory&) = delete;
+
+		~TrackedMemory() { set(0); }
+
+		/*
+		* @brief Changes the number of bytes accounted
+		*/
+		void set(size_t newBytes)
+		{
+			if (newBytes > bytes)
+				MemoryTracker::allocated(category, newBytes - bytes);
+
+			else if (newBytes < bytes)
+				MemoryTracker::freed(category, bytes - newBytes);
+
+			bytes = newBytes;
+		}
+
+		/*
+		* @brief Gets the number of bytes accounted
+		*/
+		size_t get() const { return bytes; }
+};
+
+/*
+* @brief Accounts memory to a category for as long as a shared handle (or any copy of it) exists
+*
+* @param handle Handle to track
+* @param category Category to account the memory to
+* @param bytes Size of the object including anything it owns
+*
+* @return A handle to the same object that frees the accounted memory along with the object
+*/
+template<typename T>
+std::shared_ptr<T> trackShared(std::shared_ptr<T> handle, MemoryCategory category, size_t bytes)
+{
+	/*
+	* @brief Owns the original handle and the accounted memory
+	*/
+	struct Tracked
+	{
+		std::shared_ptr<T> handle;
+		TrackedMemory memory;
+
+		Tracked(std::shared_ptr<T> handle, MemoryCategory category, size_t bytes) : handle(std::move(handle)), memory(category, bytes) {}
+	};
+
+	T* object = handle.get();
+	return std::shared_ptr<T>(std::make_shared<Tracked>(std::move(handle), category, bytes), object);
+}
+
+/*
+* @brief Gives a class its own new and delete that account every instance (including derived classes) to a category
+*/
+#define TRACK_MEMORY(CATEGORY) \
+	static void* operator new(size_t bytes) { MemoryTracker::allocated(CATEGORY, bytes); return ::operator new(bytes); } \
+	static void operator delete(void* memory, size_t bytes) { MemoryTracker::freed(CATEGORY, bytes); ::operator delete(memory); }
@@ -10,8 +10,8 @@
 * @param map The container to iterate over
 * @param key The key to search for
 */
-template<typename IDENTIFIER, typename VALUE>
-bool inMap(const std::unordered_map<IDENTIFIER, VALUE>& map, const IDENTIFIER& key)
+template<typename IDENTIFIER, typename VALUE, typename HASH>
+bool inMap(const std::unordered_map<IDENTIFIER, VALUE, HASH>& map, const IDENTIFIER& key)
 {
 	return map.find(key) != map.end();
 }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <util/libs.h>
+
+/*
+* @brief Stable LSD radix sort of items by a 64-bit key (8 passes of 8 bits)
+* 
+* Passes where every key has the same byte are skipped, so keys that only use a few of their bits sort in a few passes
+* 
+* @param items The items to sort
+* @param scratch Buffer the passes ping-pong through (reuse it between calls to avoid allocating)
+* @param getKey Function that returns the 64-bit key of an item
+*/
+template<typename ITEM, typename GET_KEY>
+void radixSort64(std::vector<ITEM>& items, std::vector<ITEM>& scratch, const GET_KEY& getKey)
+{
+	constexpr size_t PASSES = 8;
+	constexpr size_t BUCKETS = 256;
+
+	size_t count = items.size();
+
+	// Nothing to sort
+	if (count < 2)
+		return;
+
+	scratch.resize(count);
+
+	// Builds the histogram of every pass with a single read of the keys
+	std::array<std::array<uint32_t, BUCKETS>, PASSES> histograms = {};
+
+	for (size_t i = 0; i < count; i++)
+	{
+		uint64_t key = getKey(items[i]);
+
+		for (size_t pass = 0; pass < PASSES; pass++)
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+	}
+
+	ITEM* src = items.data();
+	ITEM* dst = scratch.data();
+
+	for (size_t pass = 0; pass < PASSES; pass++)
+	{
+		std::array<uint32_t, BUCKETS>& histogram = histograms[pass];
+		size_t shift = pass * 8;
+
+		// Skips the pass if every key has the same byte here
+		if (histogram[(getKey(src[0]) >> shift) & 0xFF] == count)
+			continue;
+
+		// Turns the counts into the starting offset of each bucket
+		uint32_t offset = 0;
+
+		for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+		{
+			uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset = offset + bucketCount;
+		}
+
+		// Scatters the items into their buckets
+		for (size_t i = 0; i < count; i++)
+			dst[histogram[(getKey(src[i]) >> shift) & 0xFF]++] = std::move(src[i]);
+
+		std::swap(src, dst);
+	}
+
+	// Moves the result back into items if the last pass wrote to the scratch buffer
+	if (src != items.data())
+		items.swap(scratch);
+}
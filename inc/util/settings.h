@@ -26,6 +26,59 @@ constexpr float MAX_X_VELOCITY = 100.0f;
 // Maximum y-velocity an object can have
 constexpr float MAX_Y_VELOCITY = 100.0f;
 
+// Directory that all asset paths (fonts, shaders, textures, levels) are relative to
+constexpr const char* ASSET_ROOT_DIRECTORY = "C:/Users/Pasha/source/github-repos/Box2D-Game-Engine/";
+
+// Path of the texture manifest relative to the asset root directory
+constexpr const char* TEXTURE_MANIFEST_PATH = "res/json/textures.json";
+
+// Directory convex decompositions of hitboxes are cached in, relative to the asset root directory
+constexpr const char* HITBOX_CACHE_DIRECTORY = "res/cache/hitboxes/";
+
+// Time each frame can spend creating the entities of levels loaded with Engine::loadLevelAsync (milliseconds)
+constexpr float LEVEL_LOAD_BUDGET_MS = 4.0f;
+
+// Number of updates between each print of the memory use of every category to the console (0 to never print it)
+constexpr size_t MEMORY_DUMP_INTERVAL = 600;
+
+// Number of frames the metrics percentiles are computed over
+constexpr size_t METRICS_WINDOW = 600;
+
+// Number of frames between each line of metrics written (when a metrics file or socket is open)
+constexpr size_t METRICS_WRITE_INTERVAL = 60;
+
+// Whether the frame governor lowers the quality while frames run over budget
+constexpr bool GOVERNOR_ENABLED = true;
+
+// Time each frame can spend in its update and render before the quality is lowered (milliseconds, under 1/60th of a second)
+constexpr float GOVERNOR_BUDGET_MS = 14.0f;
+
+// Frames over budget before the quality is lowered one level
+constexpr unsigned int GOVERNOR_DOWNGRADE_FRAMES = 3;
+
+// Frames under GOVERNOR_UPGRADE_HEADROOM of the budget before the quality is raised one level
+constexpr unsigned int GOVERNOR_UPGRADE_FRAMES = 120;
+constexpr float GOVERNOR_UPGRADE_HEADROOM = 0.7f;
+
+// Whether dynamic bodies far from the view are simulated less (see SimulationLOD)
+constexpr bool SIMULATION_LOD_ENABLED = true;
+
+// Dynamic bodies further than this from the centre of the view are only stepped every SIMULATION_REDUCED_INTERVAL steps (meters)
+constexpr float SIMULATION_REDUCED_RADIUS = 40.0f;
+constexpr unsigned int SIMULATION_REDUCED_INTERVAL = 4;
+
+// Dynamic bodies further than this from the centre of the view are disabled until they come closer (meters)
+constexpr float SIMULATION_FROZEN_RADIUS = 80.0f;
+
+// Extra distance a body has to move out past a radius before it is simulated less (meters)
+constexpr float SIMULATION_LOD_HYSTERESIS = 5.0f;
+
+// Most particles alive at once (new particles are dropped once it is reached)
+constexpr size_t MAX_PARTICLES = 100000;
+
+// Steps between each raycast of a colliding particle (the casts of the particles are spread across the steps)
+constexpr unsigned int PARTICLE_COLLISION_INTERVAL = 4;
+
 // --------------------------------------------------------------------------------------------------------------------- //
 // Modifying any of the settings below is not fully supported by the engine 											 //
 // Editing these settings may cause the engine to not function propely or not at all 									 //
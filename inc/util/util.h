@@ -3,7 +3,9 @@
 // Include all the utility headers
 
 #include <util/lib-overload.h>
+#include <util/memoryTracker.h>
+#include <util/radixSort.h>
 #include <util/settings.h>
 #include <util/libs.h>
 #include <util/vec2.h>
-#include <util/misc.h>
\ No newline at end of file
+#include <util/misc.h>
@@ -2,6 +2,14 @@
 
 #include <util/libs.h>
 
+// Uses SSE2 for the batch functions where the compiler targets it (every x86-64 compiler does)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VEC2_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define VEC2_USE_SSE2 0
+#endif
+
 /*
 * @brief A simple 2D vector class
 */
@@ -11,77 +19,183 @@ struct Vec2
 	float x, y;
 
 	// Simple constructors
-	Vec2() : x(0), y(0) {}
-	Vec2(float xy) : x(xy), y(xy) {}
-	Vec2(float x, float y) : x(x), y(y) {}
+	constexpr Vec2() noexcept : x(0), y(0) {}
+	constexpr Vec2(float xy) noexcept : x(xy), y(xy) {}
+	constexpr Vec2(float x, float y) noexcept : x(x), y(y) {}
+
+	// SFML and Box2D vectors are not literal types so their conversions cannot be constexpr
 
 	// SFML conversion - sf::Vector2f
-	Vec2(sf::Vector2f vec) : x(vec.x), y(vec.y) {}
-	operator sf::Vector2f() { return sf::Vector2f(x, y); }
+	Vec2(sf::Vector2f vec) noexcept : x(vec.x), y(vec.y) {}
+	operator sf::Vector2f() const noexcept { return sf::Vector2f(x, y); }
 
 	// SFML conversion - sf::Vector2i
-	Vec2(sf::Vector2i vec) : x((float)vec.x), y((float)vec.y) {}
-	operator sf::Vector2i() { return sf::Vector2i((int)x, (int)y); }
+	Vec2(sf::Vector2i vec) noexcept : x((float)vec.x), y((float)vec.y) {}
+	operator sf::Vector2i() const noexcept { return sf::Vector2i((int)x, (int)y); }
 
 	// SFML conversion - sf::Vector2u
-	Vec2(sf::Vector2u vec) : x((float)vec.x), y((float)vec.y) {}
-	operator sf::Vector2u() { return sf::Vector2u((unsigned int)x, (unsigned int)y); }
+	Vec2(sf::Vector2u vec) noexcept : x((float)vec.x), y((float)vec.y) {}
+	operator sf::Vector2u() const noexcept { return sf::Vector2u((unsigned int)x, (unsigned int)y); }
 
 	// Box2D conversion - b2Vec2
-	Vec2 (b2Vec2 vec) : x(vec.x), y(vec.y) {}
-	operator b2Vec2() { return b2Vec2(x, y); }
+	Vec2 (b2Vec2 vec) noexcept : x(vec.x), y(vec.y) {}
+	operator b2Vec2() const noexcept { return b2Vec2(x, y); }
 
 	// Sets the vector to zero
-	void setZero() { x = 0; y = 0; }
+	constexpr void setZero() noexcept { x = 0; y = 0; }
 
 	// Sets the vector to the numeric limit
-	void setInf()
+	constexpr void setInf() noexcept
 	{
 		x = std::numeric_limits<float>::max();
 		y = std::numeric_limits<float>::max();
 	}
 
 	// Sets the vector to the negative numeric limit
-	void setNegInf()
+	constexpr void setNegInf() noexcept
 	{
-		x = std::numeric_limits<float>::min();
-		y = std::numeric_limits<float>::min();
+		x = std::numeric_limits<float>::lowest();
+		y = std::numeric_limits<float>::lowest();
 	}
 
 	// Gets the length of the vector
-	float length() { return sqrt(x * x + y * y); }
+	float length() const noexcept { return std::sqrt(x * x + y * y); }
 
 	// Gets the squared length of the vector (useful for performance)
-	float lengthSquared() { return x * x + y * y; }
+	constexpr float lengthSquared() const noexcept { return x * x + y * y; }
+
+	// Dot product
+	constexpr float dot(const Vec2& other) const noexcept { return x * other.x + y * other.y; }
+
+	// Cross product (the z of the 3D cross product, positive when other is counter-clockwise of this)
+	constexpr float cross(const Vec2& other) const noexcept { return x * other.y - y * other.x; }
+
+	// Gets the vector with a length of 1 (the zero vector stays zero)
+	Vec2 normalized() const noexcept
+	{
+		float len = length();
+		return len > 0.0f ? Vec2(x / len, y / len) : Vec2();
+	}
+
+	// Makes the length of the vector 1 and returns the old length (the zero vector stays zero)
+	float normalize() noexcept
+	{
+		float len = length();
+
+		if (len > 0.0f)
+		{
+			x = x / len;
+			y = y / len;
+		}
+
+		return len;
+	}
+
+	// Compound assignment operators
+
+	constexpr Vec2& operator+=(const Vec2& other) noexcept { x = x + other.x; y = y + other.y; return *this; }
+	constexpr Vec2& operator-=(const Vec2& other) noexcept { x = x - other.x; y = y - other.y; return *this; }
+	constexpr Vec2& operator*=(const Vec2& other) noexcept { x = x * other.x; y = y * other.y; return *this; }
+	constexpr Vec2& operator/=(const Vec2& other) noexcept { x = x / other.x; y = y / other.y; return *this; }
+
+	constexpr Vec2& operator*=(float scale) noexcept { x = x * scale; y = y * scale; return *this; }
+	constexpr Vec2& operator/=(float scale) noexcept { x = x / scale; y = y / scale; return *this; }
 };
 
-// Addition operator overload
+// The batch functions treat arrays of Vec2 as arrays of floats
+static_assert(sizeof(Vec2) == sizeof(float) * 2 && std::is_standard_layout<Vec2>::value, "Vec2 must be two packed floats");
+
+// Arithmetic operator overloads (component-wise, neither side is changed)
+
+constexpr Vec2 operator+(const Vec2& lhs, const Vec2& rhs) noexcept { return Vec2(lhs.x + rhs.x, lhs.y + rhs.y); }
+
+constexpr Vec2 operator-(const Vec2& lhs, const Vec2& rhs) noexcept { return Vec2(lhs.x - rhs.x, lhs.y - rhs.y); }
+
+constexpr Vec2 operator*(const Vec2& lhs, const Vec2& rhs) noexcept { return Vec2(lhs.x * rhs.x, lhs.y * rhs.y); }
+
+constexpr Vec2 operator/(const Vec2& lhs, const Vec2& rhs) noexcept { return Vec2(lhs.x / rhs.x, lhs.y / rhs.y); }
+
+constexpr Vec2 operator-(const Vec2& vec) noexcept { return Vec2(-vec.x, -vec.y); }
 
-Vec2 operator+(Vec2& lhs, Vec2& rhs);
+// Scalar overloads (exact matches so they are picked over Box2D's b2Vec2 operators)
 
-Vec2 operator-(Vec2& lhs, Vec2& rhs);
+constexpr Vec2 operator*(const Vec2& lhs, float rhs) noexcept { return Vec2(lhs.x * rhs, lhs.y * rhs); }
 
-Vec2 operator*(Vec2& lhs, Vec2& rhs);
+constexpr Vec2 operator*(float lhs, const Vec2& rhs) noexcept { return Vec2(lhs * rhs.x, lhs * rhs.y); }
 
-Vec2 operator/(Vec2& lhs, Vec2& rhs);
+constexpr Vec2 operator/(const Vec2& lhs, float rhs) noexcept { return Vec2(lhs.x / rhs, lhs.y / rhs); }
 
-bool operator==(Vec2& lhs, Vec2& rhs);
+// Comparison operator overloads
 
-bool operator!=(Vec2& lhs, Vec2& rhs);
+constexpr bool operator==(const Vec2& lhs, const Vec2& rhs) noexcept { return lhs.x == rhs.x && lhs.y == rhs.y; }
+
+constexpr bool operator!=(const Vec2& lhs, const Vec2& rhs) noexcept { return lhs.x != rhs.x || lhs.y != rhs.y; }
+
+// Batch functions (work in place when out and in are the same)
+
+/*
+* @brief Sets out[i] = in[i] * scale + offset for every vector (for example scale by Engine::pxToMeter to go from meters to pixels)
+*/
+inline void transformVec2s(const Vec2* in, Vec2* out, size_t count, float scale, Vec2 offset) noexcept
+{
+	size_t i = 0;
+
+#if VEC2_USE_SSE2
+	// Two vectors per register
+	const float* inFloats = reinterpret_cast<const float*>(in);
+	float* outFloats = reinterpret_cast<float*>(out);
+
+	__m128 scales = _mm_set1_ps(scale);
+	__m128 offsets = _mm_setr_ps(offset.x, offset.y, offset.x, offset.y);
+
+	for (; i + 2 <= count; i += 2)
+		_mm_storeu_ps(outFloats + i * 2, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(inFloats + i * 2), scales), offsets));
+#endif
+
+	// Whatever is left over (everything without SSE2)
+	for (; i < count; i++)
+		out[i] = in[i] * scale + offset;
+}
+
+/*
+* @brief Multiplies every vector by a scale
+*/
+inline void scaleVec2s(Vec2* vectors, size_t count, float scale) noexcept
+{
+	transformVec2s(vectors, vectors, count, scale, Vec2());
+}
+
+/*
+* @brief Adds an offset to every vector
+*/
+inline void translateVec2s(Vec2* vectors, size_t count, Vec2 offset) noexcept
+{
+	transformVec2s(vectors, vectors, count, 1.0f, offset);
+}
 
 // STD operator overloads
 
 namespace std
 {
-	Vec2 abs(Vec2& vec);
+	// Absolute function
+	inline Vec2 abs(const Vec2& vec) { return Vec2(std::abs(vec.x), std::abs(vec.y)); }
 
-	ostream& operator<<(ostream& os, const Vec2& vec);
+	// Console output
+	inline ostream& operator<<(ostream& os, const Vec2& vec)
+	{
+		os << "(" << vec.x << ", " << vec.y << ")";
+		return os;
+	}
 
-	string to_string(Vec2& vec);
+	// To string
+	inline string to_string(const Vec2& vec) { return to_string(vec.x) + " " + to_string(vec.y); }
 
-	Vec2 min(Vec2& lhs, Vec2& rhs);
+	// Min function
+	inline Vec2 min(const Vec2& lhs, const Vec2& rhs) { return Vec2(std::min(lhs.x, rhs.x), std::min(lhs.y, rhs.y)); }
 
-	Vec2 max(Vec2& lhs, Vec2& rhs);
+	// Max function
+	inline Vec2 max(const Vec2& lhs, const Vec2& rhs) { return Vec2(std::max(lhs.x, rhs.x), std::max(lhs.y, rhs.y)); }
 
-	Vec2 floor(Vec2& vec);
-}
\ No newline at end of file
+	// Floor function (rounds down)
+	inline Vec2 floor(const Vec2& vec) { return Vec2(std::floor(vec.x), std::floor(vec.y)); }
+}
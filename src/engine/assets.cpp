@@ -0,0 +1,418 @@
+#include <engine/assets.h>
+
+#include <util/util.h>
+
+static std::string readFileToString(const std::string& path)
+{
+	// Opens the file in binary mode so the contents are not changed
+	std::ifstream file(path, std::ios::binary);
+
+	// Checks if the file is open
+	if (!file.is_open())
+		throw std::runtime_error("Error: could not open file " + path);
+
+	// Reads the whole file in one go
+	return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// --------------- Manifest Functions --------------- //
+
+static void addFilesWithExtension(const std::filesystem::path& root, const std::string& directory, const std::vector<std::string>& extensions, std::vector<std::string>& out)
+{
+	std::filesystem::path fullDirectory = root / directory;
+
+	// Skips directories that do not exist
+	if (!std::filesystem::is_directory(fullDirectory))
+		return;
+
+	// Adds every file with a matching extension (as a path relative to the root)
+	for (const auto& entry : std::filesystem::directory_iterator(fullDirectory))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		std::string extension = entry.path().extension().string();
+
+		for (const std::string& allowed : extensions)
+		{
+			if (extension == allowed)
+				out.push_back(std::filesystem::relative(entry.path(), root).generic_string());
+		}
+	}
+}
+
+AssetManifest loadAssetManifest(const std::string& rootDirectory)
+{
+	AssetManifest manifest;
+	std::filesystem::path root(rootDirectory);
+
+	// Finds all the fonts and fragment shaders
+	addFilesWithExtension(root, "res/fonts", { ".ttf", ".otf" }, manifest.fonts);
+	addFilesWithExtension(root, "glsl", { ".frag" }, manifest.shaders);
+
+	// Opens the texture manifest (it is allowed to not exist)
+	std::ifstream file(root / TEXTURE_MANIFEST_PATH);
+
+	if (!file.is_open())
+		return manifest;
+
+	// Loads file into a JSON object
+	nl::json manifestJson;
+	file >> manifestJson;
+
+	// Returns early if the manifest does not list any textures
+	if (!manifestJson.contains("textures"))
+		return manifest;
+
+	// Checks that textures is an array
+	if (!manifestJson["textures"].is_array())
+		throw std::runtime_error("Error: textures is not an array in JSON file");
+
+	// Loops through each texture
+	for (const auto& texture : manifestJson["textures"])
+	{
+		TextureManifestEntry entry;
+		entry.name = texture.at("name").get<std::string>();
+		entry.path = texture.at("path").get<std::string>();
+
+		manifest.textures.push_back(entry);
+	}
+
+	return manifest;
+}
+
+// --------------- AssetCache Member Functions --------------- //
+
+AssetCache::AssetCache(const std::string& rootDirectory) : rootDirectory(rootDirectory)
+{}
+
+AssetCache::~AssetCache()
+{
+	// Futures from std::async block in their destructor anyway, this just makes it explicit
+	waitForPreload();
+}
+
+std::string AssetCache::normalise(const std::string& path)
+{
+	// Removes things like "./" and "a/../" and uses forward slashes on every platform
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::string AssetCache::fullPath(const std::string& key) const
+{
+	return (rootDirectory / key).string();
+}
+
+AssetHandle<sf::Shader> AssetCache::compileShader(const std::string& key, const std::string& source)
+{
+	// Compiles the shader
+	AssetHandle<sf::Shader> shader = std::make_shared<sf::Shader>();
+
+	if (!shader->loadFromMemory(source, sf::Shader::Fragment))
+		throw std::runtime_error("Error: could not compile shader " + key);
+
+	// Stores it in the cache
+	shaders[key] = shader;
+	return shader;
+}
+
+AssetHandle<sf::Texture> AssetCache::uploadTexture(const std::string& key, const sf::Image& image)
+{
+	// Uploads the image to the GPU
+	AssetHandle<sf::Texture> texture = std::make_shared<sf::Texture>();
+
+	if (!texture->loadFromImage(image))
+		throw std::runtime_error("Error: could not create texture " + key);
+
+	// Accounts the GPU copy of the pixels (estimated as 4 bytes each)
+	texture = trackShared(texture, MemoryCategory::ASSETS, (size_t)image.getSize().x * image.getSize().y * 4);
+
+	// Stores it in the cache
+	textures[key] = texture;
+	return texture;
+}
+
+void AssetCache::throwIfFailed(const std::string& key)
+{
+	auto failed = failedLoads.find(key);
+
+	if (failed == failedLoads.end())
+		return;
+
+	// Only thrown once, the next request loads the asset again
+	std::string error = failed->second;
+	failedLoads.erase(failed);
+
+	throw std::runtime_error(error);
+}
+
+AssetHandle<sf::Font> AssetCache::getFont(const std::string& path)
+{
+	std::string key = normalise(path);
+
+	// Returns the cached font if it is already loaded
+	auto found = fonts.find(key);
+
+	if (found != fonts.end())
+		return found->second;
+
+	// Rethrows the error if the background load failed
+	throwIfFailed(key);
+
+	// Finishes the background load if there is one
+	auto pending = pendingFonts.find(key);
+
+	if (pending != pendingFonts.end())
+	{
+		// Removed before get so an error from the worker is only rethrown once
+		auto future = std::move(pending->second);
+		pendingFonts.erase(pending);
+
+		AssetHandle<sf::Font> font = future.get();
+
+		fonts[key] = font;
+		return font;
+	}
+
+	// Otherwise loads it now
+	AssetHandle<sf::Font> font = std::make_shared<sf::Font>();
+
+	if (!font->loadFromFile(fullPath(key)))
+		throw std::runtime_error("Error: could not load font " + key);
+
+	fonts[key] = font;
+	return font;
+}
+
+AssetHandle<sf::Shader> AssetCache::getShader(const std::string& path)
+{
+	std::string key = normalise(path);
+
+	// Returns the cached shader if it is already loaded
+	auto found = shaders.find(key);
+
+	if (found != shaders.end())
+		return found->second;
+
+	// Rethrows the error if the background load failed
+	throwIfFailed(key);
+
+	// Finishes the background load if there is one
+	auto pending = pendingShaders.find(key);
+
+	if (pending != pendingShaders.end())
+	{
+		// Removed before get so an error from the worker is only rethrown once
+		auto future = std::move(pending->second);
+		pendingShaders.erase(pending);
+
+		std::string source = future.get();
+
+		return compileShader(key, source);
+	}
+
+	// Otherwise loads it now
+	return compileShader(key, readFileToString(fullPath(key)));
+}
+
+AssetHandle<sf::Texture> AssetCache::getTexture(const std::string& path)
+{
+	std::string key = normalise(path);
+
+	// Returns the cached texture if it is already loaded
+	auto found = textures.find(key);
+
+	if (found != textures.end())
+		return found->second;
+
+	// Otherwise uploads the decoded image
+	return uploadTexture(key, *getImage(key));
+}
+
+AssetHandle<sf::Image> AssetCache::getImage(const std::string& path)
+{
+	std::string key = normalise(path);
+
+	// Returns the cached image if it is already decoded
+	auto found = images.find(key);
+
+	if (found != images.end())
+		return found->second;
+
+	// Rethrows the error if the background load failed
+	throwIfFailed(key);
+
+	// Finishes the background load if there is one
+	auto pending = pendingTextures.find(key);
+
+	if (pending != pendingTextures.end())
+	{
+		// Removed before get so an error from the worker is only rethrown once
+		auto future = std::move(pending->second);
+		pendingTextures.erase(pending);
+
+		AssetHandle<sf::Image> image = future.get();
+
+		images[key] = image;
+		return image;
+	}
+
+	// Otherwise loads it now
+	AssetHandle<sf::Image> image = std::make_shared<sf::Image>();
+
+	if (!image->loadFromFile(fullPath(key)))
+		throw std::runtime_error("Error: could not load texture " + key);
+
+	// Accounts the decoded pixels (4 bytes each) for as long as the image is used
+	image = trackShared(image, MemoryCategory::ASSETS, (size_t)image->getSize().x * image->getSize().y * 4);
+
+	images[key] = image;
+	return image;
+}
+
+void AssetCache::preload(const AssetManifest& manifest)
+{
+	preloadTotal = 0;
+
+	// Starts a background load for every font not already loaded or loading
+	for (const std::string& path : manifest.fonts)
+	{
+		std::string key = normalise(path);
+
+		if (inMap(fonts, key) || inMap(pendingFonts, key))
+			continue;
+
+		std::string file = fullPath(key);
+
+		// Tries again an asset whose last load failed
+		failedLoads.erase(key);
+
+		pendingFonts[key] = std::async(std::launch::async, [file, key]()
+		{
+			// Fonts do not need an OpenGL context until glyphs are rendered
+			AssetHandle<sf::Font> font = std::make_shared<sf::Font>();
+
+			if (!font->loadFromFile(file))
+				throw std::runtime_error("Error: could not load font " + key);
+
+			return font;
+		});
+
+		preloadTotal++;
+	}
+
+	// Starts a background read for every shader (they are compiled on the main thread)
+	for (const std::string& path : manifest.shaders)
+	{
+		std::string key = normalise(path);
+
+		if (inMap(shaders, key) || inMap(pendingShaders, key))
+			continue;
+
+		// Tries again an asset whose last load failed
+		failedLoads.erase(key);
+
+		pendingShaders[key] = std::async(std::launch::async, readFileToString, fullPath(key));
+
+		preloadTotal++;
+	}
+
+	// Starts a background decode for every texture (they are uploaded on the main thread when first used)
+	for (const TextureManifestEntry& entry : manifest.textures)
+	{
+		std::string key = normalise(entry.path);
+
+		if (inMap(images, key) || inMap(pendingTextures, key))
+			continue;
+
+		std::string file = fullPath(key);
+
+		// Tries again an asset whose last load failed
+		failedLoads.erase(key);
+
+		pendingTextures[key] = std::async(std::launch::async, [file, key]()
+		{
+			AssetHandle<sf::Image> image = std::make_shared<sf::Image>();
+
+			if (!image->loadFromFile(file))
+				throw std::runtime_error("Error: could not load texture " + key);
+
+			return trackShared(image, MemoryCategory::ASSETS, (size_t)image->getSize().x * image->getSize().y * 4);
+		});
+
+		preloadTotal++;
+	}
+}
+
+void AssetCache::update()
+{
+	// Returns true if the future has finished without blocking
+	auto isReady = [](auto& future) { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+
+	// Removes every finished load from a pending map and passes on its result. A load that failed is kept as an
+	// error for the getter to throw so one broken asset does not throw out of every frame
+	auto finishReady = [&](auto& pending, auto finish)
+	{
+		for (auto it = pending.begin(); it != pending.end();)
+		{
+			if (!isReady(it->second)) { it++; continue; }
+
+			std::string key = it->first;
+			auto future = std::move(it->second);
+			it = pending.erase(it);
+
+			try
+			{
+				finish(key, future.get());
+			}
+
+			catch (const std::exception& error)
+			{
+				std::cout << error.what() << std::endl;
+				failedLoads[key] = error.what();
+			}
+		}
+	};
+
+	// Moves all finished fonts into the cache
+	finishReady(pendingFonts, [&](const std::string& key, AssetHandle<sf::Font> font) { fonts[key] = font; });
+
+	// Compiles all finished shaders
+	finishReady(pendingShaders, [&](const std::string& key, const std::string& source) { compileShader(key, source); });
+
+	// Moves all finished images into the cache
+	finishReady(pendingTextures, [&](const std::string& key, AssetHandle<sf::Image> image) { images[key] = image; });
+}
+
+void AssetCache::waitForPreload()
+{
+	// Waits for every worker thread to finish
+	callFuncOnMap(pendingFonts, [](const std::string&, auto& future) { future.wait(); });
+	callFuncOnMap(pendingShaders, [](const std::string&, auto& future) { future.wait(); });
+	callFuncOnMap(pendingTextures, [](const std::string&, auto& future) { future.wait(); });
+}
+
+float AssetCache::getPreloadProgress() const
+{
+	// Nothing to load counts as finished
+	if (preloadTotal == 0)
+		return 1.0f;
+
+	size_t remaining = pendingFonts.size() + pendingShaders.size() + pendingTextures.size();
+	return 1.0f - (float)std::min(remaining, preloadTotal) / (float)preloadTotal;
+}
+
+void AssetCache::releaseUnused()
+{
+	// Removes any asset that nothing outside of the cache is holding
+	auto releaseFrom = [](auto& map)
+	{
+		for (auto it = map.begin(); it != map.end();)
+			it = (it->second.use_count() == 1) ? map.erase(it) : std::next(it);
+	};
+
+	releaseFrom(fonts);
+	releaseFrom(shaders);
+	releaseFrom(textures);
+	releaseFrom(images);
+}
@@ -0,0 +1,324 @@
+#include <engine/atlas.h>
+
+#include <util/util.h>
+
+#include <algorithm>
+
+/*
+* @brief Skyline bottom-left rectangle packer for a single page
+*/
+class SkylinePacker
+{
+	private:
+		/*
+		* @brief Horizontal segment of the skyline
+		*/
+		struct Node
+		{
+			unsigned int x, y, width;
+		};
+
+		// Segments of the skyline from left to right
+		std::vector<Node> skyline;
+
+		// Size of the page
+		unsigned int size;
+
+		// Lowest point of the page that has been used
+		unsigned int usedHeight = 0;
+
+		/*
+		* @brief Gets the height a rectangle would sit at if placed at the start of a node
+		*
+		* @return False if the rectangle does not fit
+		*/
+		bool fits(size_t index, unsigned int width, unsigned int height, unsigned int& y) const
+		{
+			// Checks the rectangle does not go past the right of the page
+			if (skyline[index].x + width > size)
+				return false;
+
+			// Finds the highest segment underneath the rectangle
+			y = 0;
+			unsigned int remaining = width;
+
+			for (size_t i = index; remaining > 0; i++)
+			{
+				y = std::max(y, skyline[i].y);
+
+				if (y + height > size)
+					return false;
+
+				remaining = remaining - std::min(remaining, skyline[i].width);
+			}
+
+			return true;
+		}
+
+	public:
+		SkylinePacker(unsigned int size) : size(size)
+		{
+			skyline.push_back({ 0, 0, size });
+		}
+
+		/*
+		* @brief Tries to pack a rectangle into the page
+		*
+		* @return False if there is no space left for it
+		*/
+		bool insert(unsigned int width, unsigned int height, unsigned int& outX, unsigned int& outY)
+		{
+			size_t bestIndex = skyline.size();
+			unsigned int bestBottom = std::numeric_limits<unsigned int>::max();
+			unsigned int bestWidth = std::numeric_limits<unsigned int>::max();
+
+			// Finds the position that keeps the skyline lowest (ties go to the narrowest segment)
+			for (size_t i = 0; i < skyline.size(); i++)
+			{
+				unsigned int y;
+
+				if (!fits(i, width, height, y))
+					continue;
+
+				if (y + height < bestBottom || (y + height == bestBottom && skyline[i].width < bestWidth))
+				{
+					bestIndex = i;
+					bestBottom = y + height;
+					bestWidth = skyline[i].width;
+					outY = y;
+				}
+			}
+
+			if (bestIndex == skyline.size())
+				return false;
+
+			outX = skyline[bestIndex].x;
+
+			// Adds the top of the rectangle to the skyline
+			skyline.insert(skyline.begin() + bestIndex, { outX, outY + height, width });
+
+			// Shrinks or removes the segments now underneath the rectangle
+			for (size_t i = bestIndex + 1; i < skyline.size();)
+			{
+				unsigned int rectRight = outX + width;
+
+				if (skyline[i].x >= rectRight)
+					break;
+
+				unsigned int shrink = rectRight - skyline[i].x;
+
+				if (shrink >= skyline[i].width)
+				{
+					skyline.erase(skyline.begin() + i);
+					continue;
+				}
+
+				skyline[i].x = skyline[i].x + shrink;
+				skyline[i].width = skyline[i].width - shrink;
+				break;
+			}
+
+			// Merges neighbouring segments at the same height
+			for (size_t i = 0; i + 1 < skyline.size();)
+			{
+				if (skyline[i].y == skyline[i + 1].y)
+				{
+					skyline[i].width = skyline[i].width + skyline[i + 1].width;
+					skyline.erase(skyline.begin() + i + 1);
+				}
+
+				else
+					i++;
+			}
+
+			usedHeight = std::max(usedHeight, outY + height);
+			return true;
+		}
+
+		/*
+		* @brief Gets the lowest point of the page that has been used
+		*/
+		unsigned int getUsedHeight() const { return usedHeight; }
+};
+
+/*
+* @brief Texture waiting to be packed
+*/
+struct PackItem
+{
+	const TextureManifestEntry* entry;
+	AssetHandle<sf::Image> image;
+
+	// Size including padding and alignment
+	unsigned int paddedWidth, paddedHeight;
+
+	// Where it ended up
+	size_t page;
+	unsigned int x, y;
+};
+
+static unsigned int alignUp(unsigned int value, unsigned int alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+	unsigned int result = 1;
+
+	while (result < value)
+		result = result * 2;
+
+	return result;
+}
+
+static void copyWithExtrudedEdges(sf::Image& page, const sf::Image& image, unsigned int x, unsigned int y, unsigned int padding)
+{
+	Vec2 size = image.getSize();
+	unsigned int width = (unsigned int)size.x;
+	unsigned int height = (unsigned int)size.y;
+
+	// Copies the texture itself
+	page.copy(image, x, y);
+
+	// Fills the padding with the closest edge pixel so bilinear filtering and mip levels sample the right colour
+	for (unsigned int py = 0; py < height + padding * 2; py++)
+	{
+		for (unsigned int px = 0; px < width + padding * 2; px++)
+		{
+			bool insideX = px >= padding && px < width + padding;
+			bool insideY = py >= padding && py < height + padding;
+
+			if (insideX && insideY)
+				continue;
+
+			unsigned int srcX = std::min(std::max(px, padding), width + padding - 1) - padding;
+			unsigned int srcY = std::min(std::max(py, padding), height + padding - 1) - padding;
+
+			page.setPixel(x - padding + px, y - padding + py, image.getPixel(srcX, srcY));
+		}
+	}
+}
+
+// --------------- TextureAtlas Member Functions --------------- //
+
+void TextureAtlas::build(AssetCache& assets, const std::vector<TextureManifestEntry>& textures, const AtlasSettings& settings)
+{
+	pages.clear();
+	regions.clear();
+	pageMemory.set(0);
+
+	unsigned int pageSize = std::min(settings.maxPageSize, sf::Texture::getMaximumSize());
+	unsigned int alignment = std::max(settings.alignment, 1u);
+
+	// Gets the images of all the textures
+	std::vector<PackItem> items;
+	items.reserve(textures.size());
+
+	for (const TextureManifestEntry& entry : textures)
+	{
+		PackItem item;
+		item.entry = &entry;
+		item.image = assets.getImage(entry.path);
+
+		Vec2 size = item.image->getSize();
+		item.paddedWidth = alignUp((unsigned int)size.x + settings.padding * 2, alignment);
+		item.paddedHeight = alignUp((unsigned int)size.y + settings.padding * 2, alignment);
+
+		// Checks the texture can fit on a page at all
+		if (item.paddedWidth > pageSize || item.paddedHeight > pageSize)
+			throw std::runtime_error("Error: texture " + entry.name + " is too large for the texture atlas");
+
+		items.push_back(item);
+	}
+
+	// Packs the tallest textures first as it wastes the least space
+	std::stable_sort(items.begin(), items.end(), [](const PackItem& a, const PackItem& b)
+	{
+		if (a.paddedHeight != b.paddedHeight)
+			return a.paddedHeight > b.paddedHeight;
+
+		return a.paddedWidth > b.paddedWidth;
+	});
+
+	// Puts each texture on the first page with space, creating a new page if none has space
+	std::vector<SkylinePacker> packers;
+
+	for (PackItem& item : items)
+	{
+		bool packed = false;
+
+		for (size_t i = 0; i < packers.size() && !packed; i++)
+		{
+			if (packers[i].insert(item.paddedWidth, item.paddedHeight, item.x, item.y))
+			{
+				item.page = i;
+				packed = true;
+			}
+		}
+
+		if (!packed)
+		{
+			packers.push_back(SkylinePacker(pageSize));
+			packers.back().insert(item.paddedWidth, item.paddedHeight, item.x, item.y);
+			item.page = packers.size() - 1;
+		}
+	}
+
+	// Creates the page images (shrunk to the power of two height that is actually used)
+	std::vector<sf::Image> pageImages(packers.size());
+
+	for (size_t i = 0; i < packers.size(); i++)
+		pageImages[i].create(pageSize, std::min(nextPowerOfTwo(packers[i].getUsedHeight()), pageSize), sf::Color::Transparent);
+
+	// Copies every texture into its page and stores its region
+	for (PackItem& item : items)
+	{
+		unsigned int x = item.x + settings.padding;
+		unsigned int y = item.y + settings.padding;
+
+		copyWithExtrudedEdges(pageImages[item.page], *item.image, x, y, settings.padding);
+
+		Vec2 size = item.image->getSize();
+
+		AtlasRegion region;
+		region.textureRect = sf::FloatRect((float)x, (float)y, size.x, size.y);
+		regions[item.entry->name] = region;
+	}
+
+	// Uploads the pages to the GPU
+	size_t pageBytes = 0;
+
+	for (sf::Image& image : pageImages)
+	{
+		pages.push_back(std::make_unique<sf::Texture>());
+
+		if (!pages.back()->loadFromImage(image))
+			throw std::runtime_error("Error: could not create texture atlas page");
+
+		// 4 bytes a pixel plus a third for the mip levels
+		pageBytes += (size_t)image.getSize().x * image.getSize().y * 4 * (settings.generateMipmaps ? 4 : 3) / 3;
+
+		if (settings.generateMipmaps)
+		{
+			pages.back()->setSmooth(true);
+			pages.back()->generateMipmap();
+		}
+	}
+
+	pageMemory.set(pageBytes);
+
+	// Points the regions at their pages now they exist
+	for (PackItem& item : items)
+		regions[item.entry->name].page = pages[item.page].get();
+}
+
+const AtlasRegion* TextureAtlas::find(const std::string& name) const
+{
+	auto found = regions.find(name);
+
+	if (found == regions.end())
+		return nullptr;
+
+	return &found->second;
+}
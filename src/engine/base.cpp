@@ -1,7 +1,12 @@
 #include <engine/base.h>
+#include <engine/levelLoad.h>
+#include <engine/entity.h>
+#include <engine/particles.h>
 
 #include <util/util.h>
 
+#include <SFML/OpenGL.hpp>
+
 // Creates instances of static members of EngineSubClass
 
 Engine* EngineSubClass::engineInstance = nullptr;
@@ -12,50 +17,6 @@ size_t Engine::instanceCount = 0;
 
 const float Engine::pxToMeter = 50.0f;
 
-std::unordered_map<sf::Keyboard::Key, long> Engine::keyMap;
-std::unordered_map<sf::Mouse::Button, long> Engine::mouseMap;
-
-// ----- EngineController Functions ----- //
-
-void EngineController::onInit()
-{
-	// Calls its onInit function
-	init();
-
-	// Calls the onInit function of the child controller if it exists
-	if (childController != nullptr)
-		childController->onInit();
-}
-
-void EngineController::onUpdate()
-{
-	// Calls its onUpdate function
-	update();
-	
-	// Calls the onUpdate function of the child controller if it exists
-	if (childController != nullptr)
-		childController->onUpdate();
-}
-
-void EngineController::onRender()
-{
-	// Calls its onRender function
-	render();
-
-	// Calls the onRender function of the child controller if it exists
-	if (childController != nullptr)
-		childController->onRender();
-}
-
-void EngineController::onClose()
-{
-	// Calls its onClose function
-	close();
-
-	// Calls the onClose function of the child controller if it exists
-	if (childController != nullptr)
-		childController->onClose();
-}
 
 // ----- Contact Listener Functions ----- //
 
@@ -109,6 +70,22 @@ void Engine::ContactListener::PreSolve(b2Contact* contact, const b2Manifold* old
 		userDataA->contacts[userDataB->owner].normal = Vec2(contact->GetManifold()->localNormal);
 		userDataB->contacts[userDataA->owner].normal = Vec2(contact->GetManifold()->localNormal);
 
+		// Merged static chains cover many boxes so their position says nothing about which side was hit, the normal (from A to B) is used instead
+		if (contact->GetFixtureA()->GetType() == b2Shape::e_chain || contact->GetFixtureB()->GetType() == b2Shape::e_chain)
+		{
+			b2WorldManifold worldManifold;
+			contact->GetWorldManifold(&worldManifold);
+
+			// Only contacts that are mostly vertical ground anything
+			if (worldManifold.normal.y > 0.5f)
+				userDataA->grounded = true;
+
+			else if (worldManifold.normal.y < -0.5f)
+				userDataB->grounded = true;
+
+			return;
+		}
+
 		// Sets grounded state of the entity on top
 		bool aOnTop = userDataA->owner->getPosition().y < userDataB->owner->getPosition().y;
 
@@ -129,7 +106,7 @@ void Engine::ContactListener::PostSolve(b2Contact* contact, const b2ContactImpul
 
 // ----- Engine Functions ----- //
 
-Engine::Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller, bool fullscreen) : controller(std::move(controller))
+Engine::Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller, WindowMode mode) : windowMode(mode), controller(std::move(controller)), assets(ASSET_ROOT_DIRECTORY), shapes(std::string(ASSET_ROOT_DIRECTORY) + HITBOX_CACHE_DIRECTORY)
 {
 	// Increments the instance count
 	Engine::instanceCount++;
@@ -141,14 +118,18 @@ Engine::Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller, boo
 	if (Engine::instanceCount != 1 && !ALLOW_MULTIPLE_INSTANCES)
 		throw std::runtime_error("Multiple instances of the engine are not allowed");
 
-	// Creates the window
-	sf::VideoMode videoMode = (fullscreen) ? sf::VideoMode::getDesktopMode() : sf::VideoMode((int)windowSize.x, (int)windowSize.y);
+	// Creates the window (unless rendering offscreen)
+	if (windowMode != WindowMode::OFFSCREEN)
+	{
+		sf::VideoMode videoMode = (windowMode == WindowMode::FULLSCREEN) ? sf::VideoMode::getDesktopMode() : sf::VideoMode((int)windowSize.x, (int)windowSize.y);
 
-	window.create(videoMode, "GAME ENGINE");
-	window.setView(sf::View(sf::FloatRect(0, 0, windowSize.x, windowSize.y)));
-	window.setFramerateLimit(60);
+		window.create(videoMode, "GAME ENGINE");
+		window.setView(sf::View(sf::FloatRect(0, 0, windowSize.x, windowSize.y)));
+		window.setFramerateLimit(60);
+	}
 
 	windowRenderTexture.create(1920, 1080);
+	renderTextureMemory.set(1920 * 1080 * 4);
 
 	// Creates the box2d world
 	world = new b2World(Vec2(0.0f, 0.0f));
@@ -158,10 +139,12 @@ Engine::Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller, boo
 	windowDisplayQuad.setPrimitiveType(sf::TriangleStrip);
 	windowDisplayQuad.resize(4);
 
+	Vec2 displaySize = (windowMode == WindowMode::OFFSCREEN) ? windowSize : Vec2(window.getSize());
+
 	windowDisplayQuad[0].position = sf::Vector2f(0.0, 0.0);
-	windowDisplayQuad[1].position = sf::Vector2f((float)window.getSize().x, 0.0);
-	windowDisplayQuad[2].position = sf::Vector2f(0.0, (float)window.getSize().y);
-	windowDisplayQuad[3].position = sf::Vector2f((float)window.getSize().x, (float)window.getSize().y);
+	windowDisplayQuad[1].position = sf::Vector2f(displaySize.x, 0.0);
+	windowDisplayQuad[2].position = sf::Vector2f(0.0, displaySize.y);
+	windowDisplayQuad[3].position = sf::Vector2f(displaySize.x, displaySize.y);
 
 	windowDisplayQuad[0].texCoords = sf::Vector2f(0, 0);
 	windowDisplayQuad[1].texCoords = sf::Vector2f((float)windowRenderTexture.getSize().x, 0.0);
@@ -171,23 +154,41 @@ Engine::Engine(Vec2 windowSize, std::unique_ptr<EngineController>controller, boo
 	// I have no idea why this centres it onto the origin
 	moveView({ -1920 / 3, -1080 / 3 });
 
+	// Starts loading all the assets in the background so they are not loaded from disk mid frame
+	AssetManifest manifest = loadAssetManifest(ASSET_ROOT_DIRECTORY);
+	assets.preload(manifest);
+
+	// Packs all the textures into the atlas (waits for just the textures to finish decoding)
+	atlas.build(assets, manifest.textures);
+
 	//
 	engineClock.restart();
 
-	// Calls the init controller function if it exists
+	// Adds the particles first so the controllers can add emitters in their init
+	particleSystem = static_cast<ParticleSystem*>(addSystem(std::make_unique<ParticleSystem>()));
+
+	// Adds the controller and its children to the scheduler then initialises them in order
 	if (this->controller != nullptr)
-		this->controller->onInit();
+		addSystemChain(this->controller.get());
+
+	systems.forEach([](EngineController& system) { system.init(); });
+	systemsInitialised = true;
 }
 
 Engine::~Engine()
 {
-	// Calls the close controller function if it exists
-	if (controller != nullptr)
-		controller->onClose();
+	// Calls the close function of every controller
+	systems.forEach([](EngineController& system) { system.close(); });
 
 	// Decrements the instance count
 	Engine::instanceCount--;
 
+	// Stops any levels that are still loading (waits for their worker threads)
+	levelLoads.clear();
+
+	// Finishes any jobs still queued and stops the workers before the entities they could be using are removed
+	jobs.shutdown();
+
 	// Removes all entities
 	while (Entity::instances.size() != 0)
 		Entity::remove(Entity::instances[0].get());
@@ -196,14 +197,20 @@ Engine::~Engine()
 	delete world;
 }
 
-void Engine::update()
+void Engine::updateInput()
 {
 	// Polls window events
 
 	sf::Event event;
 
+	// Presses received by this poll are timed from the poll before (SFML does not say when they arrived)
+	input.beginPoll(std::chrono::steady_clock::now());
+
 	while (window.pollEvent(event))
 	{
+		if (input.handleEvent(event))
+			continue;
+
 		switch (event.type)
 		{
 			case sf::Event::Closed:
@@ -232,32 +239,25 @@ void Engine::update()
 	mousePos = renderTextureMousePos;
 
 
-	// Updates the keyMap and mouseMap
-
-	#define MIDPOINT 0 // Can change (no logical reason why it should not be 0)
-
-	// If LControl is not pressed, updates the keyMap and mouseMap
-	if (!sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl))
-	{
-		callFuncOnMap(keyMap, [](sf::Keyboard::Key key, long& value) { sf::Keyboard::isKeyPressed(key) ? ((value < MIDPOINT) ? value = MIDPOINT : value++) : ((value > MIDPOINT) ? value = MIDPOINT : value--); });
-		callFuncOnMap(mouseMap, [](sf::Mouse::Button button, long& value) { sf::Mouse::isButtonPressed(button) ? ((value < MIDPOINT) ? value = MIDPOINT : value++) : ((value > MIDPOINT) ? value = MIDPOINT : value--); });
-	}
+	// Moves the key and mouse button counters on by a frame (frozen while LControl is held for the editor)
+	bool editorModifier = input.isDown(sf::Keyboard::Key::LControl);
+	input.endFrame(!editorModifier);
 
 	// Sets the editor state based on the number keys
-	else
+	if (editorModifier)
 	{
 		EditorState oldState = editorState;
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Num0))
+		if (input.isDown(sf::Keyboard::Key::Num0))
 			editorState = EditorState::INACTIVE;
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Num1))
+		if (input.isDown(sf::Keyboard::Key::Num1))
 			editorState = EditorState::EDITING;
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Num2))
+		if (input.isDown(sf::Keyboard::Key::Num2))
 			editorState = EditorState::CREATING;
 
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Num3))
+		if (input.isDown(sf::Keyboard::Key::Num3))
 			editorState = EditorState::MOVING;
 
 		//
@@ -299,7 +299,7 @@ void Engine::update()
 		if (editorState != EditorState::INACTIVE)
 		{
 
-			if (sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
+			if (input.isDown(sf::Mouse::Button::Left))
 			{
 				if (editorSelectedEntity != nullptr)
 					editorSelectedEntity->selectedByEditor = false;
@@ -308,7 +308,7 @@ void Engine::update()
 
 				Vec2 m = { mousePos.x / pxToMeter, mousePos.y / pxToMeter };
 
-				possibleEditorEntities = QueryPoint(world, m);
+				possibleEditorEntities = pickEntities(m);
 
 				std::cout << "Possible Entities: " << possibleEditorEntities.size() << std::endl;
 				std::cout << "Mouse Pos: " << m.x << ", " << m.y << std::endl;
@@ -320,50 +320,213 @@ void Engine::update()
 			}
 		}
 	}
+}
+
+void Engine::update()
+{
+	auto updateStart = std::chrono::steady_clock::now();
+
+	// Finishes the metrics of the last frame (its update and render)
+	if (updateCount != 0)
+		metrics.set("frame.ms", std::chrono::duration<double, std::milli>(updateStart - lastUpdateStart).count());
+
+	lastUpdateStart = updateStart;
+
+	// Changes the quality if the last frame's work went over budget (or has had headroom for a while)
+	if (updateCount != 0)
+	{
+		governor.addFrame(lastUpdateMs + lastRenderMs);
+
+		metrics.set("governor.work_ms", lastUpdateMs + lastRenderMs);
+		metrics.set("quality.level", (double)governor.getLevel());
+		metrics.set("quality.velocity_iterations", governor.getQuality().velocityIterations);
+		metrics.set("quality.position_iterations", governor.getQuality().positionIterations);
+		metrics.set("quality.far_update_interval", governor.getQuality().farUpdateInterval);
+	}
+
+	metrics.endFrame();
+
+	// Starts counting the allocations of this update
+	MemoryTracker::endFrame();
+
+	// Prints the memory use every few updates
+	updateCount++;
+
+	if (MEMORY_DUMP_INTERVAL != 0 && updateCount % MEMORY_DUMP_INTERVAL == 0)
+		MemoryTracker::dump(std::cout);
+
+	// Finishes any assets that have loaded in the background
+	assets.update();
+
+	// There is no window to get input from when rendering offscreen
+	if (windowMode != WindowMode::OFFSCREEN)
+		updateInput();
+
+	// Creates the next entities of any levels loading in the background (sharing the budget between them)
+	float loadBudget = LEVEL_LOAD_BUDGET_MS / (float)std::max(levelLoads.size(), (size_t)1);
+
+	for (size_t i = 0; i < levelLoads.size();)
+	{
+		if (levelLoads[i]->update(loadBudget))
+			levelLoads.erase(levelLoads.begin() + i);
 
-	// Calls all Entity::preStepUpdate functions
+		else
+			i++;
+	}
+
+	QualityLevel quality = governor.getQuality();
+
+	// Steps far bodies less often (more so when the governor has lowered the quality)
+	simulationLOD.update(getViewCenter() / pxToMeter, quality.farUpdateInterval, updateCount);
+
+	// Calls all Entity::preStepUpdate functions (except for the entities sitting this step out)
 	for (std::unique_ptr<Entity>& entity : Entity::instances)
-		entity->preStepUpdate();
+	{
+		if (!entity->skippedUpdate)
+			entity->preStepUpdate();
+	}
+
+	// The presses polled this frame are used by this step (their latency is measured once the frame is displayed)
+	input.onStep();
 
-	// Updates the b2World
-	world->Step(1.0f / 60.0f, 8, 3);
+	// Updates the b2World (with fewer solver iterations when the governor has lowered the quality)
+	world->Step(1.0f / 60.0f, quality.velocityIterations, quality.positionIterations);
 
 	// Calls the update functions of all entities
 	for (std::unique_ptr<Entity>& entity : Entity::instances)
-		entity->postStepUpdate();
+	{
+		if (!entity->skippedUpdate)
+			entity->postStepUpdate();
+	}
+
+	recordPhysicsMetrics();
+
+	// Updates the controllers (independent ones in parallel)
+	systems.update(jobs);
+
+	lastUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - updateStart).count();
+	metrics.set("frame.update_ms", lastUpdateMs);
+}
+
+void Engine::forgetEntities(const std::unordered_set<Entity*>& removed)
+{
+	if (removed.count(editorSelectedEntity) != 0)
+		editorSelectedEntity = nullptr;
+
+	possibleEditorEntities.erase(std::remove_if(possibleEditorEntities.begin(), possibleEditorEntities.end(), [&removed](Entity* entity)
+	{
+		return removed.count(entity) != 0;
+	}), possibleEditorEntities.end());
+}
 
-	// Calls the update controller function if it exists
-	if (controller != nullptr)
-		controller->onUpdate();
+void Engine::recordPhysicsMetrics()
+{
+	// Time Box2D spent in each part of the step (milliseconds)
+	const b2Profile& profile = world->GetProfile();
+
+	metrics.set("physics.step_ms", profile.step);
+	metrics.set("physics.collide_ms", profile.collide);
+	metrics.set("physics.solve_ms", profile.solve);
+	metrics.set("physics.solve_toi_ms", profile.solveTOI);
+	metrics.set("physics.broadphase_ms", profile.broadphase);
+
+	// Size of the world
+	metrics.set("physics.bodies", world->GetBodyCount());
+	metrics.set("physics.contacts", world->GetContactCount());
+	metrics.set("physics.proxies", world->GetProxyCount());
+
+	metrics.set("entities", (double)Entity::instances.size());
+
+	// Bodies in each simulation tier
+	metrics.set("simulation.full", (double)simulationLOD.getCount(SimulationTier::FULL));
+	metrics.set("simulation.reduced", (double)simulationLOD.getCount(SimulationTier::REDUCED));
+	metrics.set("simulation.frozen", (double)simulationLOD.getCount(SimulationTier::FROZEN));
+
+	// Memory allocated during the last update and in use now
+	size_t allocations = 0;
+	size_t bytes = 0;
+
+	for (size_t i = 0; i < (size_t)MemoryCategory::COUNT; i++)
+	{
+		MemoryStats stats = MemoryTracker::getStats((MemoryCategory)i);
+
+		allocations = allocations + stats.frameAllocations;
+		bytes = bytes + stats.currentBytes;
+	}
+
+	metrics.set("memory.allocations", (double)allocations);
+	metrics.set("memory.kb", (double)(bytes / 1024));
 }
 
 void Engine::render()
 {
+	auto renderStart = std::chrono::steady_clock::now();
+
 	// Clears the window
 	window.clear(sf::Color::Black);
 
 	// Clears the render texture
 	windowRenderTexture.clear();
 
-	// Calls the render controller function if it exists
-	if (controller != nullptr)
-		controller->onRender();
+	// Calls the render function of every controller
+	systems.forEach([](EngineController& system) { system.render(); });
+
+	// Sorts, batches and draws everything the controllers recorded
+	renderQueue.flush(windowRenderTexture);
 
 	// Displays the render texture
 	windowRenderTexture.display();
 
-	// Sets global shader uniforms
+	// Draws made into the render texture (the post process pass is added below)
+	size_t drawCalls = renderQueue.getDrawCount();
+	size_t shaderPasses = renderQueue.getShaderDrawCount();
+
+	metrics.set("render.vertices", (double)renderQueue.getVertexCount());
+	metrics.set("render.culled", (double)renderQueue.getCulledCount());
+	metrics.set("particles.count", (double)particleSystem->getCount());
+	metrics.set("particles.drawn", (double)particleSystem->getDrawnCount());
+
+	frameCount++;
 
-	testShader.setUniform("time", engineClock.getElapsedTime().asSeconds());
-	testShader.setUniform("resolution", sf::Glsl::Vec2((float)window.getSize().x, (float)window.getSize().y));
+	// Copies the frame back to the CPU if requested (slow so it is only done every few frames)
+	if (readbackInterval != 0 && frameCount % readbackInterval == 0)
+		lastReadback = windowRenderTexture.getTexture().copyToImage();
+
+	// Nothing else to draw to when rendering offscreen
+	if (windowMode == WindowMode::OFFSCREEN)
+	{
+		lastRenderMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+
+		metrics.set("render.draw_calls", (double)drawCalls);
+		metrics.set("render.shader_passes", (double)shaderPasses);
+		metrics.set("frame.render_ms", lastRenderMs);
+
+		return;
+	}
 
 	// Draws the render texture to the window
 	sf::RenderStates states;
 	states.texture = &windowRenderTexture.getTexture();
-	states.shader = &testShader;
+
+	// Sets global shader uniforms (the governor skips the post processing when frames are over budget)
+	if (postProcessShader != nullptr && governor.getQuality().postProcess)
+	{
+		postProcessShader->setUniform("time", engineClock.getElapsedTime().asSeconds());
+		postProcessShader->setUniform("resolution", sf::Glsl::Vec2((float)window.getSize().x, (float)window.getSize().y));
+
+		states.shader = postProcessShader.get();
+	}
 
 	window.draw(windowDisplayQuad, states);
 
+	drawCalls++;
+
+	if (states.shader != nullptr)
+		shaderPasses++;
+
+	metrics.set("render.draw_calls", (double)drawCalls);
+	metrics.set("render.shader_passes", (double)shaderPasses);
+
 	//
 	if (editorState != EditorState::INACTIVE)
 	{
@@ -380,11 +543,12 @@ void Engine::render()
 
 		if (editorState != EditorState::INACTIVE)
 		{
-			sf::Font font;
-			font.loadFromFile("C:/Users/Pasha/source/github-repos/Box2D-Game-Engine/res/fonts/BlockFont.ttf");
+			// Loads the font the first time the editor is opened
+			if (editorFont == nullptr)
+				editorFont = assets.getFont("res/fonts/BlockFont.ttf");
 
 			sf::Text editorInfoText;
-			editorInfoText.setFont(font);
+			editorInfoText.setFont(*editorFont);
 			editorInfoText.setCharacterSize(24);
 			editorInfoText.setFillColor(sf::Color::White);
 
@@ -417,6 +581,9 @@ void Engine::render()
 
 				else if (editorSelectedEntity->type == EntityType::GRAPHIC_PHYSICAL)
 					editorInfoString += "Physical";
+
+				else if (editorSelectedEntity->type == EntityType::STATIC_CHAIN)
+					editorInfoString += "Merged static";
 			}
 
 			editorInfoText.setString(editorInfoString);
@@ -433,59 +600,129 @@ void Engine::render()
 			editorInfoBoxDivider.setPosition(windowDisplayQuad[1].position.x + 10, 70);
 
 			window.draw(editorInfoBoxDivider);
+
+			// Memory of each category (current, peak and allocations during the last frame)
+			sf::Text memoryText;
+			memoryText.setFont(*editorFont);
+			memoryText.setCharacterSize(16);
+			memoryText.setFillColor(sf::Color::White);
+
+			std::string memoryString = "Memory (KB / peak KB / allocs per frame)";
+
+			for (size_t i = 0; i < (size_t)MemoryCategory::COUNT; i++)
+			{
+				MemoryStats stats = MemoryTracker::getStats((MemoryCategory)i);
+
+				memoryString += "\n" + std::string(MemoryTracker::getName((MemoryCategory)i)) + ": " + std::to_string(stats.currentBytes / 1024)
+					+ " / " + std::to_string(stats.peakBytes / 1024) + " / " + std::to_string(stats.frameAllocations);
+			}
+
+			memoryText.setString(memoryString);
+			memoryText.setPosition(windowDisplayQuad[1].position.x + 20, 90);
+
+			window.draw(memoryText);
 		}
 
 	}
 
+	// Measured before displaying as display waits for the frame limit
+	lastRenderMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+	metrics.set("frame.render_ms", lastRenderMs);
+
 	// Displays the window
 	window.display();
+
+	// Measured after display so the wait for the frame limit is included
+	input.onDisplay(std::chrono::steady_clock::now());
 }
 
-void Engine::moveView(Vec2 offset)
+void Engine::finishRendering()
 {
-	sf::View view = windowRenderTexture.getView();
-	view.move(offset.x, offset.y);
-	windowRenderTexture.setView(view);
+	// glFinish only waits for the commands of the active context
+	if (windowRenderTexture.setActive(true))
+		glFinish();
 }
 
-long Engine::getInputInfo(sf::Keyboard::Key key)
+void Engine::stop()
 {
-	// Checks key is in the keyMap
-	if (keyMap.find(key) == keyMap.end())
-		return 0;
+	running = false;
 
-	// Returns the value of the key in the keyMap
-	return keyMap[key];
+	// Closes the window if there is one
+	if (windowMode != WindowMode::OFFSCREEN)
+		window.close();
 }
 
-long Engine::getInputInfo(sf::Mouse::Button button)
+void Engine::setPostProcessShader(const std::string& path)
 {
-	// Checks button is in the mouseMap
-	if (mouseMap.find(button) == mouseMap.end())
-		return 0;
+	// Removes the shader if no path is given
+	if (path.empty())
+		postProcessShader = nullptr;
 
-	// Returns the value of the button in the mouseMap
-	return mouseMap[button];
+	else
+		postProcessShader = assets.getShader(path);
 }
 
-void Engine::addInput(sf::Keyboard::Key key)
+std::shared_ptr<LevelLoad> Engine::loadLevelAsync(const std::string& levelPath, std::function<void(Level&)> onComplete)
 {
-	// Throws an error if the key is LControl (as it is used for the debug console)
-	if (key == sf::Keyboard::Key::LControl)
-		throw std::runtime_error("Cannot add LControl to keyMap");
+	// Starts parsing straight away, the entities are created during update
+	levelLoads.push_back(std::make_shared<LevelLoad>(levelPath, std::move(onComplete)));
 
-	// Adds the key to the keyMap if it is not already in it
-	if (!inMap(keyMap, key))
-	{
-		keyMap[key] = 0;
-	}
+	return levelLoads.back();
+}
+
+const Prefab& Engine::registerPrefab(const std::string& name, const PhysicalDef& def)
+{
+	prefabs[name] = std::make_unique<Prefab>(def);
+
+	return *prefabs[name];
+}
+
+const Prefab& Engine::getPrefab(const std::string& name) const
+{
+	auto found = prefabs.find(name);
+
+	if (found == prefabs.end())
+		throw std::runtime_error("Error: prefab " + name + " has not been registered");
+
+	return *found->second;
 }
 
-void Engine::addInput(sf::Mouse::Button button)
+void Engine::addSystemChain(EngineController* controller)
 {
-	// Adds the button to the mouseMap if it is not already in it
-	if (!inMap(mouseMap, button))
+	for (EngineController* system = controller; system != nullptr; system = system->childController.get())
+		systems.add(system);
+}
+
+EngineController* Engine::addSystem(std::unique_ptr<EngineController> system)
+{
+	if (system == nullptr)
+		throw std::runtime_error("Error: cannot add a null system");
+
+	extraSystems.push_back(std::move(system));
+	EngineController* added = extraSystems.back().get();
+
+	addSystemChain(added);
+
+	// Systems added after the engine started are initialised straight away
+	if (systemsInitialised)
 	{
-		mouseMap[button] = 0;
+		for (EngineController* child = added; child != nullptr; child = child->childController.get())
+			child->init();
 	}
+
+	return added;
+}
+
+void Engine::moveView(Vec2 offset)
+{
+	sf::View view = windowRenderTexture.getView();
+	view.move(offset.x, offset.y);
+	windowRenderTexture.setView(view);
+}
+
+void Engine::addInput(sf::Keyboard::Key key)
+{
+	// Throws an error if the key is LControl (as it is used for the debug console)
+	if (key == sf::Keyboard::Key::LControl)
+		throw std::runtime_error("Cannot add LControl to keyMap");
 }
\ No newline at end of file
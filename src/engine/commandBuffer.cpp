@@ -0,0 +1,59 @@
+#include <engine/commandBuffer.h>
+
+#include <util/util.h>
+
+void CommandBuffer::addCommand(RenderCommandType type, const sf::RenderStates& states, int layer, float depth, size_t first, size_t count)
+{
+	RenderCommand command;
+	command.type = type;
+	command.layer = layer;
+	command.depth = depth;
+	command.states = states;
+	command.first = (uint32_t)first;
+	command.count = (uint32_t)count;
+
+	commands.push_back(command);
+}
+
+void CommandBuffer::quad(const sf::Vertex* corners, const sf::RenderStates& states, int layer, float depth)
+{
+	// Copies the corners into the vertex storage
+	size_t first = vertices.size();
+	vertices.insert(vertices.end(), corners, corners + 4);
+
+	addCommand(RenderCommandType::QUAD, states, layer, depth, first, 4);
+}
+
+sf::Vertex* CommandBuffer::lines(size_t vertexCount, const sf::RenderStates& states, int layer, float depth)
+{
+	// Makes space for the vertices which the caller fills in
+	size_t first = vertices.size();
+	vertices.resize(first + vertexCount);
+
+	addCommand(RenderCommandType::LINES, states, layer, depth, first, vertexCount);
+
+	return vertices.data() + first;
+}
+
+void CommandBuffer::text(const sf::Text& text, const sf::RenderStates& states, int layer, float depth)
+{
+	texts.push_back(text);
+
+	addCommand(RenderCommandType::TEXT, states, layer, depth, texts.size() - 1, 1);
+}
+
+void CommandBuffer::custom(const sf::Drawable& drawable, const sf::RenderStates& states, int layer, float depth)
+{
+	drawables.push_back(&drawable);
+
+	addCommand(RenderCommandType::CUSTOM, states, layer, depth, drawables.size() - 1, 1);
+}
+
+void CommandBuffer::clear()
+{
+	commands.clear();
+	vertices.clear();
+	texts.clear();
+	drawables.clear();
+	copies.clear();
+}
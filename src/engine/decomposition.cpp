@@ -0,0 +1,432 @@
+#include <engine/decomposition.h>
+
+#include <algorithm>
+#include <cstring>
+
+// Magic number and version at the start of decomposition cache files
+static const char DECOMPOSITION_MAGIC[4] = { 'B', '2', 'C', 'D' };
+constexpr uint32_t DECOMPOSITION_VERSION = 1;
+
+static float cross(const Vec2& a, const Vec2& b, const Vec2& c)
+{
+	// Cross product of (b - a) and (c - b) (positive when a, b, c turn counter-clockwise)
+	return (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+}
+
+static float signedArea(const std::vector<Vec2>& outline)
+{
+	float area = 0.0f;
+
+	for (size_t i = 0; i < outline.size(); i++)
+	{
+		const Vec2& a = outline[i];
+		const Vec2& b = outline[(i + 1) % outline.size()];
+
+		area = area + a.x * b.y - b.x * a.y;
+	}
+
+	return area / 2.0f;
+}
+
+bool isConvex(const std::vector<Vec2>& outline)
+{
+	// Every turn must go the same way
+	bool positive = false, negative = false;
+
+	for (size_t i = 0; i < outline.size(); i++)
+	{
+		float turn = cross(outline[i], outline[(i + 1) % outline.size()], outline[(i + 2) % outline.size()]);
+
+		positive = positive || turn > 0.0f;
+		negative = negative || turn < 0.0f;
+	}
+
+	return !(positive && negative);
+}
+
+/*
+* @brief Removes repeated and collinear vertices
+*/
+static std::vector<Vec2> cleanOutline(const std::vector<Vec2>& outline)
+{
+	std::vector<Vec2> cleaned = outline;
+	bool changed = true;
+
+	while (changed && cleaned.size() >= 3)
+	{
+		changed = false;
+
+		for (size_t i = 0; i < cleaned.size() && cleaned.size() >= 3; i++)
+		{
+			const Vec2& previous = cleaned[(i + cleaned.size() - 1) % cleaned.size()];
+			const Vec2& current = cleaned[i];
+			const Vec2& next = cleaned[(i + 1) % cleaned.size()];
+
+			float dx = current.x - previous.x, dy = current.y - previous.y;
+			bool repeated = dx * dx + dy * dy <= b2_linearSlop * b2_linearSlop;
+
+			if (repeated || std::abs(cross(previous, current, next)) <= std::numeric_limits<float>::epsilon())
+			{
+				cleaned.erase(cleaned.begin() + i);
+				changed = true;
+				i--;
+			}
+		}
+	}
+
+	return cleaned;
+}
+
+static bool segmentsCross(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+{
+	// Each segment has the ends of the other strictly on opposite sides
+	return cross(a, b, c) * cross(a, b, d) < 0.0f && cross(c, d, a) * cross(c, d, b) < 0.0f;
+}
+
+/*
+* @brief Checks no two edges that are not neighbours cross each other
+*/
+static bool isSimple(const std::vector<Vec2>& outline)
+{
+	size_t count = outline.size();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		for (size_t j = i + 2; j < count; j++)
+		{
+			// The first and last edges are neighbours
+			if (i == 0 && j == count - 1)
+				continue;
+
+			if (segmentsCross(outline[i], outline[(i + 1) % count], outline[j], outline[(j + 1) % count]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static bool pointInTriangle(const Vec2& p, const Vec2& a, const Vec2& b, const Vec2& c)
+{
+	// Points on the edges count as inside so ears never touch another vertex
+	return cross(a, b, p) >= 0.0f && cross(b, c, p) >= 0.0f && cross(c, a, p) >= 0.0f;
+}
+
+/*
+* @brief Triangulates a counter-clockwise simple polygon by ear clipping
+* 
+* @return Indices of the vertices of each triangle (empty if the polygon is not simple)
+*/
+static std::vector<std::vector<size_t>> triangulate(const std::vector<Vec2>& outline)
+{
+	std::vector<std::vector<size_t>> triangles;
+	std::vector<size_t> remaining(outline.size());
+
+	for (size_t i = 0; i < outline.size(); i++)
+		remaining[i] = i;
+
+	while (remaining.size() > 3)
+	{
+		bool clipped = false;
+
+		for (size_t i = 0; i < remaining.size() && !clipped; i++)
+		{
+			size_t a = remaining[(i + remaining.size() - 1) % remaining.size()];
+			size_t b = remaining[i];
+			size_t c = remaining[(i + 1) % remaining.size()];
+
+			// Reflex vertices can not be ears
+			if (cross(outline[a], outline[b], outline[c]) <= 0.0f)
+				continue;
+
+			// Checks no other vertex is inside the ear
+			bool ear = true;
+
+			for (size_t j : remaining)
+			{
+				if (j != a && j != b && j != c && pointInTriangle(outline[j], outline[a], outline[b], outline[c]))
+				{
+					ear = false;
+					break;
+				}
+			}
+
+			if (ear)
+			{
+				triangles.push_back({ a, b, c });
+				remaining.erase(remaining.begin() + i);
+				clipped = true;
+			}
+		}
+
+		// A simple polygon always has an ear
+		if (!clipped)
+			return {};
+	}
+
+	triangles.push_back(remaining);
+	return triangles;
+}
+
+/*
+* @brief Tries to merge two pieces that share an edge
+* 
+* @return False if they do not share an edge or the result would not be convex or would have too many vertices
+*/
+static bool tryMerge(const std::vector<Vec2>& outline, const std::vector<size_t>& a, const std::vector<size_t>& b, size_t maxVertices, std::vector<size_t>& merged)
+{
+	if (a.size() + b.size() - 2 > maxVertices)
+		return false;
+
+	// Finds an edge of a that is the reverse of an edge of b
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		size_t start = a[i];
+		size_t end = a[(i + 1) % a.size()];
+
+		for (size_t j = 0; j < b.size(); j++)
+		{
+			if (b[j] != end || b[(j + 1) % b.size()] != start)
+				continue;
+
+			// Walks a from the end of the shared edge round to its start, then b from past the start round to before the end
+			merged.clear();
+
+			for (size_t k = 0; k < a.size(); k++)
+				merged.push_back(a[(i + 1 + k) % a.size()]);
+
+			for (size_t k = 2; k < b.size(); k++)
+				merged.push_back(b[(j + k) % b.size()]);
+
+			// Checks the merged piece is still convex
+			for (size_t k = 0; k < merged.size(); k++)
+			{
+				const Vec2& p0 = outline[merged[k]];
+				const Vec2& p1 = outline[merged[(k + 1) % merged.size()]];
+				const Vec2& p2 = outline[merged[(k + 2) % merged.size()]];
+
+				if (cross(p0, p1, p2) < 0.0f)
+					return false;
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::vector<std::vector<Vec2>> decomposeConvex(const std::vector<Vec2>& outline, size_t maxVertices)
+{
+	std::vector<Vec2> cleaned = cleanOutline(outline);
+
+	if (cleaned.size() < 3)
+		throw std::runtime_error("Error: hitbox has less than 3 distinct vertices");
+
+	// Works with counter-clockwise outlines
+	if (signedArea(cleaned) < 0.0f)
+		std::reverse(cleaned.begin(), cleaned.end());
+
+	// Outlines that are already usable are returned as they are
+	if (isConvex(cleaned) && cleaned.size() <= maxVertices)
+		return { cleaned };
+
+	// Splits the outline into triangles
+	std::vector<std::vector<size_t>> pieces;
+
+	if (isSimple(cleaned))
+		pieces = triangulate(cleaned);
+
+	if (pieces.empty())
+		throw std::runtime_error("Error: hitbox is not a simple polygon (its edges cross)");
+
+	// Removes diagonals while the pieces on both sides make a convex piece (Hertel-Mehlhorn)
+	std::vector<size_t> merged;
+	bool changed = true;
+
+	while (changed)
+	{
+		changed = false;
+
+		for (size_t i = 0; i < pieces.size() && !changed; i++)
+		{
+			for (size_t j = i + 1; j < pieces.size() && !changed; j++)
+			{
+				if (tryMerge(cleaned, pieces[i], pieces[j], maxVertices, merged))
+				{
+					pieces[i] = merged;
+					pieces.erase(pieces.begin() + j);
+					changed = true;
+				}
+			}
+		}
+	}
+
+	// Converts the indices back to vertices
+	std::vector<std::vector<Vec2>> result(pieces.size());
+
+	for (size_t i = 0; i < pieces.size(); i++)
+	{
+		for (size_t index : pieces[i])
+			result[i].push_back(cleaned[index]);
+	}
+
+	return result;
+}
+
+// --------------- DecompositionCache Member Functions --------------- //
+
+DecompositionCache::DecompositionCache(const std::string& directory) : directory(directory)
+{}
+
+static uint64_t hashBytes(const std::string& bytes)
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+
+	for (char byte : bytes)
+	{
+		hash = hash ^ (uint8_t)byte;
+		hash = hash * 1099511628211ull;
+	}
+
+	return hash;
+}
+
+bool DecompositionCache::readFromDisk(const std::string& path, const std::vector<Vec2>& outline, std::vector<std::vector<Vec2>>& pieces) const
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	// Reads a value of any plain type
+	auto read = [&file](auto& value) { return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(value)); };
+
+	char magic[4];
+	uint32_t version, vertexCount;
+
+	if (!file.read(magic, 4) || std::memcmp(magic, DECOMPOSITION_MAGIC, 4) != 0 || !read(version) || version != DECOMPOSITION_VERSION)
+		return false;
+
+	// Checks the file is for this outline (not just an outline with the same hash)
+	if (!read(vertexCount) || vertexCount != outline.size())
+		return false;
+
+	for (const Vec2& vertex : outline)
+	{
+		float x, y;
+
+		if (!read(x) || !read(y) || x != vertex.x + 0.0f || y != vertex.y + 0.0f)
+			return false;
+	}
+
+	// Reads the pieces
+	uint32_t pieceCount;
+
+	if (!read(pieceCount))
+		return false;
+
+	pieces.assign(pieceCount, {});
+
+	for (std::vector<Vec2>& piece : pieces)
+	{
+		uint32_t count;
+
+		if (!read(count) || count < 3 || count > b2_maxPolygonVertices)
+			return false;
+
+		piece.resize(count);
+
+		for (Vec2& vertex : piece)
+		{
+			if (!read(vertex.x) || !read(vertex.y))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void DecompositionCache::writeToDisk(const std::string& path, const std::vector<Vec2>& outline, const std::vector<std::vector<Vec2>>& pieces) const
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	// Writes to a temporary file first so a half written file is never read
+	std::string tempPath = path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return;
+
+	// Writes a value of any plain type
+	auto write = [&file](const auto& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+	file.write(DECOMPOSITION_MAGIC, 4);
+	write(DECOMPOSITION_VERSION);
+
+	write((uint32_t)outline.size());
+
+	for (const Vec2& vertex : outline)
+	{
+		write(vertex.x + 0.0f);
+		write(vertex.y + 0.0f);
+	}
+
+	write((uint32_t)pieces.size());
+
+	for (const std::vector<Vec2>& piece : pieces)
+	{
+		write((uint32_t)piece.size());
+
+		for (const Vec2& vertex : piece)
+		{
+			write(vertex.x);
+			write(vertex.y);
+		}
+	}
+
+	file.close();
+
+	if (file.good())
+		std::filesystem::rename(tempPath, path, error);
+
+	else
+		std::filesystem::remove(tempPath, error);
+}
+
+const std::vector<std::vector<Vec2>>& DecompositionCache::get(const std::vector<Vec2>& outline, const std::string& key)
+{
+	// Checks memory first
+	auto found = decompositions.find(key);
+
+	if (found != decompositions.end())
+		return found->second;
+
+	std::vector<std::vector<Vec2>> pieces;
+
+	// Outlines that are already usable are never written to the disk
+	if (outline.size() <= b2_maxPolygonVertices && isConvex(outline))
+		pieces = { outline };
+
+	else
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hashBytes(key));
+
+		std::string path = directory.empty() ? "" : (std::filesystem::path(directory) / name).string();
+
+		// Then the disk, then decomposes it
+		if (path.empty() || !readFromDisk(path, outline, pieces))
+		{
+			pieces = decomposeConvex(outline);
+			decomposedCount++;
+
+			if (!path.empty())
+				writeToDisk(path, outline, pieces);
+		}
+	}
+
+	return decompositions.emplace(key, std::move(pieces)).first->second;
+}
@@ -60,8 +60,42 @@ void drawRect::setColor(sf::Color color)
 	}
 }
 
+void drawRect::setTexture(const AtlasRegion* region)
+{
+	// Goes back to a flat color if there is no region
+	if (region == nullptr)
+	{
+		texture = nullptr;
+		return;
+	}
+
+	texture = region->page;
+
+	// Writes the corners of the region as the texture coordinates (same order as the positions)
+	sf::FloatRect rect = region->textureRect;
+
+	vertices[0].texCoords = sf::Vector2f(rect.left, rect.top);
+	vertices[1].texCoords = sf::Vector2f(rect.left + rect.width, rect.top);
+	vertices[2].texCoords = sf::Vector2f(rect.left, rect.top + rect.height);
+	vertices[3].texCoords = sf::Vector2f(rect.left + rect.width, rect.top + rect.height);
+}
+
+void drawRect::record(CommandBuffer& buffer, sf::RenderStates states, int layer, float depth) const
+{
+	// Uses the atlas page if the rectangle is textured
+	if (texture != nullptr)
+		states.texture = texture;
+
+	// Records the corners of the rectangle
+	buffer.quad(&vertices[0], states, layer, depth);
+}
+
 void drawRect::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	// Uses the atlas page if the rectangle is textured
+	if (texture != nullptr)
+		states.texture = texture;
+
 	// Draw the rectangle
 	target.draw(vertices, states);
 }
@@ -8,6 +8,9 @@
 // Entity vector (Defined in class but has to be created here)
 std::vector<std::unique_ptr<Entity>> Entity::instances;
 
+// Id of the next entity (Defined in class but has to be created here)
+uint64_t Entity::nextId = 0;
+
 b2BodyType convertFromStr(const std::string& str)
 {
 	// Converts the string to a b2BodyType
@@ -58,29 +61,38 @@ void Entity::setSize(Vec2 size)
 {
 	// Do I need a comment here?
 	this->size = size;
+	markDirty();
 }
 
 void Entity::setPosition(Vec2 position)
 {
 	// No I don't need a comment here
 	this->position = position;
+	markDirty();
 }
 
 void Entity::remove(Entity* entity)
 {
-	// Loops through all the instances in the instances vector
-	for (size_t i = 0; i < instances.size(); i++)
+	remove(std::unordered_set<Entity*>{ entity });
+}
+
+void Entity::remove(const std::unordered_set<Entity*>& entities)
+{
+	if (entities.empty())
+		return;
+
+	// Clears the editor's selection first so it never points at a destroyed entity
+	if (engineInstance != nullptr)
+		engineInstance->forgetEntities(entities);
+
+	// Removes every entity in the set in a single pass (each one is destroyed as it is overwritten or erased)
+	instances.erase(std::remove_if(instances.begin(), instances.end(), [&entities](const std::unique_ptr<Entity>& instance)
 	{
-		// If the instance is the same as the entity, it is removed from the vector
-		if (instances[i].get() == entity)
-		{
-			instances.erase(instances.begin() + i);
-			return;
-		}
-	}
+		return entities.count(instance.get()) != 0;
+	}), instances.end());
 }
 
-Entity::Entity()
+Entity::Entity() : id(nextId++)
 {}
 
 // --------------- GraphicEntity Member Functions --------------- //
@@ -95,6 +107,44 @@ GraphicEntity::GraphicEntity(bool call)
 	renderStates.transform.scale(Vec2(engineInstance->pxToMeter));
 }
 
+const AtlasRegion* GraphicEntity::findTexture(const std::string& name)
+{
+	// No texture means a flat color
+	if (name.empty())
+		return nullptr;
+
+	// Finds the texture in the atlas
+	const AtlasRegion* region = engineInstance->atlas.find(name);
+
+	if (region == nullptr)
+		throw std::runtime_error("Error: texture " + name + " is not in the texture manifest");
+
+	return region;
+}
+
+void GraphicEntity::setTexture(const std::string& name)
+{
+	drawable.setTexture(findTexture(name));
+	textureName = name;
+	markDirty();
+}
+
+void GraphicEntity::initGraphic(const GraphicDef& def, const AtlasRegion* region)
+{
+	// Sets the size and position of the instance to the values in the def struct
+	size = def.size;
+	position = def.position;
+
+	// Sets the drawable object to the parameters in the def struct
+	drawable.setHalfSize(def.size);
+	drawable.setPosition(def.position);
+	drawable.setTexture(region);
+
+	textureName = def.texture;
+	layer = def.layer;
+	depth = def.depth;
+}
+
 void GraphicEntity::render()
 {
 	//
@@ -104,8 +154,22 @@ void GraphicEntity::render()
 	else
 		drawable.setColor(sf::Color::White);
 
-	// Renders the drawable object to the Engine window
-	engineInstance->draw(drawable, renderStates);
+	// Records the drawable object into the Engine command buffer
+	drawable.record(engineInstance->getCommandBuffer(), renderStates, layer, depth);
+}
+
+void GraphicEntity::setDrawOrder(int layer, float depth)
+{
+	this->layer = layer;
+	this->depth = depth;
+	markDirty();
+}
+
+void GraphicEntity::teleport(Vec2 position)
+{
+	// Moves the entity and its drawable object
+	setPosition(position);
+	drawable.setPosition(position);
 }
 
 // --------------- PhysicalEntity Member Functions --------------- //
@@ -158,8 +222,14 @@ void PhysicalEntity::preStepUpdate()
 
 void PhysicalEntity::postStepUpdate()
 {
-	// Gets the position from the b2Body pointer
-	position = body->GetPosition();
+	// Gets the position from the b2Body pointer (only marking the entity as changed if it actually moved)
+	b2Vec2 bodyPosition = body->GetPosition();
+
+	if (bodyPosition.x != position.x || bodyPosition.y != position.y)
+	{
+		position = bodyPosition;
+		markDirty();
+	}
 
 	// Sets the velocity to the velocity of the body
 	velocity = body->GetLinearVelocity();
@@ -177,38 +247,46 @@ void PhysicalEntity::render()
 	else
 		drawable.setColor(sf::Color::White);
 
-	// Renders the drawable object to the Engine window
-	engineInstance->draw(drawable, renderStates);
+	// Records the drawable object into the Engine command buffer
+	drawable.record(engineInstance->getCommandBuffer(), renderStates, layer, depth);
 
-	// Loops through all the shapes in the shapes vector
-	for (size_t i = 0; i < shapes.size(); i++)
-	{
-		// Casts the shape pointer to a b2PolygonShape
-		b2PolygonShape* shape = static_cast<b2PolygonShape*>(shapes[i].get());
+	// Hitboxes are only drawn while debug drawing is on
+	if (!engineInstance->isDebugDrawing())
+		return;
 
-		// Creates a new VertexArray object with the correct size and type
-		sf::VertexArray hitbox(sf::LineStrip, shape->m_count + 1);
+	//
+	sf::Color chosenColor = sf::Color::Red;
 
-		//
-		sf::Color chosenColor = sf::Color::Red;
+	if (getB2UserData()->grounded)
+		chosenColor = sf::Color::Green;
 
-		if (getB2UserData()->grounded)
-			chosenColor = sf::Color::Green;
+	// Counts the vertices needed for the outlines of all the hitboxes (2 per edge)
+	size_t vertexCount = 0;
 
-		// Loops through all the vertices in the shape and sets the position and color
-		for (int32 j = 0; j < shape->m_count + 1; j++)
-		{
-			if (j == shape->m_count)
-				hitbox[shape->m_count].position = Vec2(body->GetWorldPoint(shape->m_vertices[0]));
+	for (const std::shared_ptr<const Hitbox>& hitbox : hitboxes)
+	{
+		for (const std::shared_ptr<b2PolygonShape>& shape : hitbox->pieces)
+			vertexCount = vertexCount + shape->m_count * 2;
+	}
 
-			else
-				hitbox[j].position = Vec2(body->GetWorldPoint(shape->m_vertices[j]));
+	// Records the hitboxes on the debug layer so they are drawn on top of everything
+	sf::Vertex* hitboxVertices = engineInstance->getCommandBuffer().lines(vertexCount, renderStates, RenderQueue::DEBUG_LAYER, depth);
 
-			hitbox[j].color = chosenColor;
+	// Loops through every convex piece of every hitbox
+	for (const std::shared_ptr<const Hitbox>& hitbox : hitboxes)
+	{
+		for (const std::shared_ptr<b2PolygonShape>& shape : hitbox->pieces)
+		{
+			// Adds a line for each edge of the shape
+			for (int32 j = 0; j < shape->m_count; j++)
+			{
+				Vec2 start = body->GetWorldPoint(shape->m_vertices[j]);
+				Vec2 end = body->GetWorldPoint(shape->m_vertices[(j + 1) % shape->m_count]);
+
+				*hitboxVertices++ = sf::Vertex(start, chosenColor);
+				*hitboxVertices++ = sf::Vertex(end, chosenColor);
+			}
 		}
-
-		// Draws the hitbox to the Engine window
-		engineInstance->draw(hitbox, renderStates);
 	}
 }
 
@@ -233,7 +311,16 @@ void PhysicalEntity::setVelocity(Vec2 velocity)
 void PhysicalEntity::addVelocity(Vec2 velocity)
 {
 	// Adds the velocity to the body
-	this->velocity = this->velocity + velocity;
+	this->velocity += velocity;
+}
+
+void PhysicalEntity::teleport(Vec2 position)
+{
+	// Moves the body without destroying it (wakes it so it reacts to its new surroundings)
+	body->SetTransform(position, body->GetAngle());
+	body->SetAwake(true);
+
+	GraphicEntity::teleport(position);
 }
 
 B2CustomUserData* PhysicalEntity::getB2UserData()
@@ -242,10 +329,119 @@ B2CustomUserData* PhysicalEntity::getB2UserData()
 	return reinterpret_cast<B2CustomUserData*>(body->GetUserData().pointer);
 }
 
+void PhysicalEntity::initBody(b2BodyType bodyType, const std::vector<std::shared_ptr<const Hitbox>>& bodyHitboxes, bool createFixtures)
+{
+	// Creates the body and sets the position and type
+
+	b2BodyDef bodyDef;
+	bodyDef.type = bodyType;
+	bodyDef.position = position;
+
+	bodyDef.fixedRotation = true;
+
+	body = engineInstance->world->CreateBody(&bodyDef);
+
+	// Keeps the hitboxes (they are still kept for saving and debug drawing when there are no fixtures)
+	hitboxes = bodyHitboxes;
+
+	// Creates a fixture for each convex piece of each hitbox
+
+	for (size_t i = 0; i < hitboxes.size() && createFixtures; i++)
+	{
+		for (const std::shared_ptr<b2PolygonShape>& shape : hitboxes[i]->pieces)
+		{
+			// Creates a b2FixtureDef
+			b2FixtureDef fixtureDef;
+			
+			// Assigns the created shape
+			fixtureDef.shape = shape.get();
+
+			// Assigns default values to the fixtureDef
+			fixtureDef.density = 1.0f;
+			fixtureDef.friction = 0.0f;
+			fixtureDef.restitution = 0.0f;
+
+			// Creates the fixture and assigns it to the body
+			body->CreateFixture(&fixtureDef);
+		}
+	}
+
+	// Creates a new B2CustomUserData object and assigns the instance to the owner
+	B2CustomUserData* instanceUserData = new B2CustomUserData;
+	instanceUserData->owner = this;
+
+	// Assigns the instanceUserData to the body's user data
+	body->GetUserData().pointer = reinterpret_cast<uintptr_t>(instanceUserData);
+}
+
+// --------------- StaticChainEntity Member Functions --------------- //
+
+StaticChainEntity::StaticChainEntity()
+{
+	// Sets correct render state transform scale
+	renderStates.transform.scale(Vec2(engineInstance->pxToMeter));
+}
+
+StaticChainEntity::~StaticChainEntity()
+{
+	if (body == nullptr)
+		return;
+
+	// Gets the user data before the body is deleted
+	B2CustomUserData* userData = reinterpret_cast<B2CustomUserData*>(body->GetUserData().pointer);
+
+	// Deletes the body from the world and the user data
+	engineInstance->world->DestroyBody(body);
+	delete userData;
+}
+
+void StaticChainEntity::render()
+{
+	// The chains have no drawable of their own so nothing is drawn without debug drawing
+	if (!engineInstance->isDebugDrawing())
+		return;
+
+	// Counts the vertices needed for the outlines (2 per edge)
+	size_t vertexCount = 0;
+
+	for (const std::vector<Vec2>& loop : loops)
+		vertexCount = vertexCount + loop.size() * 2;
+
+	// Records the outlines on the debug layer so they are drawn on top of everything
+	sf::Vertex* outlineVertices = engineInstance->getCommandBuffer().lines(vertexCount, renderStates, RenderQueue::DEBUG_LAYER);
+
+	for (const std::vector<Vec2>& loop : loops)
+	{
+		for (size_t i = 0; i < loop.size(); i++)
+		{
+			const Vec2& start = loop[i];
+			const Vec2& end = loop[(i + 1) % loop.size()];
+
+			*outlineVertices++ = sf::Vertex(start, sf::Color::Yellow);
+			*outlineVertices++ = sf::Vertex(end, sf::Color::Yellow);
+		}
+	}
+}
+
+// --------------- Prefab Member Functions --------------- //
+
+Prefab::Prefab(const PhysicalDef& def) : def(def)
+{
+	// Looks up the texture and builds the hitboxes once for every copy
+	region = GraphicEntity::findTexture(def.texture);
+	hitboxes.reserve(def.fixtureVertices.size());
+
+	for (const std::vector<Vec2>& outline : def.fixtureVertices)
+		hitboxes.push_back(engineInstance->shapes.getHitbox(outline));
+}
+
 // --------------- Creation functions for entities --------------- //
 
-GraphicEntity* GraphicEntity::create(GraphicDef def)
+GraphicEntity* GraphicEntity::create(const GraphicDef& def)
 {
+	// Finds the texture first so nothing is created if it is missing
+	const AtlasRegion* region = findTexture(def.texture);
+
 	// Creates a new instance of GraphicEntity and adds it to the instances vector
 	instances.push_back(std::make_unique<GraphicEntity>());
 
@@ -256,20 +452,25 @@ GraphicEntity* GraphicEntity::create(GraphicDef def)
 	// Sets the type of the instance to GRAPHIC_ONLY
 	instance->type = EntityType::GRAPHIC_ONLY;
 
-	// Sets the size and position of the instance to the values in the def struct
-	instance->size = def.size;
-	instance->position = def.position;
-
-	// Sets the drawable object to the parameters in the def struct
-	instance->drawable.setHalfSize(def.size);
-	instance->drawable.setPosition(def.position);
+	// Sets the size, position and drawable of the instance to the values in the def struct
+	instance->initGraphic(def, region);
 
 	// Returns the instance
 	return instance;
 }
 
-PhysicalEntity* PhysicalEntity::create(PhysicalDef def)
+PhysicalEntity* PhysicalEntity::create(const PhysicalDef& def, bool createFixtures)
 {
+	// Finds the texture first so nothing is created if it is missing
+	const AtlasRegion* region = findTexture(def.texture);
+
+	// Gets the hitboxes (identical hitboxes share their shapes through the engine's cache, concave ones are split)
+	std::vector<std::shared_ptr<const Hitbox>> hitboxes;
+	hitboxes.reserve(def.fixtureVertices.size());
+
+	for (const std::vector<Vec2>& outline : def.fixtureVertices)
+		hitboxes.push_back(engineInstance->shapes.getHitbox(outline));
+
 	// Creates a new instance of PhysicalEntity and adds it to the instances vector
 	instances.push_back(std::make_unique<PhysicalEntity>());
 
@@ -280,71 +481,102 @@ PhysicalEntity* PhysicalEntity::create(PhysicalDef def)
 	// Sets the type of the instance to GRAPHIC_PHYSICAL
 	instance->type = EntityType::GRAPHIC_PHYSICAL;
 
-	// Sets the size and position of the instance to the values in the def struct
-	instance->size = def.size;
-	instance->position = def.position;
+	// Sets the size, position and drawable of the instance to the values in the def struct
+	instance->initGraphic(def, region);
 
-	// Sets the drawable object to the parameters in the def struct
-	instance->drawable.setHalfSize(def.size);
-	instance->drawable.setPosition(def.position);
+	// Creates the body and its fixtures
+	instance->initBody(def.bodyType, hitboxes, createFixtures);
 
-	// Creates the body and sets the position and type
-
-	b2BodyDef bodyDef;
-	bodyDef.type = def.bodyType;
-	bodyDef.position = def.position;
-
-	bodyDef.fixedRotation = true;
+	// Returns the instance
+	return instance;
+}
 
-	instance->body = engineInstance->world->CreateBody(&bodyDef);
+std::vector<PhysicalEntity*> PhysicalEntity::spawnMany(const Prefab& prefab, const Vec2* positions, size_t count)
+{
+	std::vector<PhysicalEntity*> spawned;
+	spawned.reserve(count);
 
-	// Creates the shapes for the fixtures
+	// Makes space for every instance at once
+	Entity::reserve(count);
 
-	for (size_t i = 0; i < def.fixtureVertices.size(); i++)
+	for (size_t i = 0; i < count; i++)
 	{
-		// Creates a new b2PolygonShape object and a new b2Vec2 array
-		b2PolygonShape shape;
-		b2Vec2* vertices = new b2Vec2[def.fixtureVertices[i].size()];
+		// Creates a new instance of PhysicalEntity and adds it to the instances vector
+		instances.push_back(std::make_unique<PhysicalEntity>());
+		PhysicalEntity* instance = static_cast<PhysicalEntity*>(instances.back().get());
+
+		instance->type = EntityType::GRAPHIC_PHYSICAL;
 
-		// Loops through all the vertices in the fixtureVertices vector and sets the values in the array
-		for (size_t j = 0; j < def.fixtureVertices[i].size(); j++)
-			vertices[j] = def.fixtureVertices[i][j];
+		// Uses the texture and hitboxes the prefab already resolved
+		instance->initGraphic(prefab.def, prefab.region);
+		instance->position = positions[i];
+		instance->drawable.setPosition(positions[i]);
 
-		// Sets the shape to the vertices array and deletes the array
-		shape.Set(vertices, def.fixtureVertices[i].size());
-		delete[] vertices;
+		instance->initBody(prefab.def.bodyType, prefab.hitboxes, true);
 
-		// Adds the shape to the shapes vector
-		instance->shapes.push_back(std::make_shared<b2PolygonShape>(shape));
+		spawned.push_back(instance);
 	}
 
-	// Creates the fixtures
+	return spawned;
+}
+
+StaticChainEntity* StaticChainEntity::create(const std::vector<std::vector<Vec2>>& loops)
+{
+	// Creates a new instance of StaticChainEntity and adds it to the instances vector
+	instances.push_back(std::make_unique<StaticChainEntity>());
+	StaticChainEntity* instance = static_cast<StaticChainEntity*>(instances.back().get());
+
+	instance->type = EntityType::STATIC_CHAIN;
+	instance->loops = loops;
+
+	// Creates the body at the origin as the outlines are already in world space
+	b2BodyDef bodyDef;
+	bodyDef.type = b2_staticBody;
+
+	instance->body = engineInstance->world->CreateBody(&bodyDef);
+
+	// Finds the bounds of the outlines to use as the position and size of the entity
+	Vec2 min, max;
+	min.setInf();
+	max.setNegInf();
 
-	for (size_t i = 0; i < def.fixtureVertices.size(); i++)
+	// Creates a chain loop fixture for each outline
+	for (const std::vector<Vec2>& loop : loops)
 	{
-		// Creates a b2FixtureDef
-		b2FixtureDef fixtureDef;
-		
-		// Assigns the created shape
-		fixtureDef.shape = instance->shapes[i].get();
+		std::vector<b2Vec2> vertices(loop.size());
+
+		for (size_t i = 0; i < loop.size(); i++)
+		{
+			vertices[i] = loop[i];
 
-		// Assigns default values to the fixtureDef
+			min = std::min(min, loop[i]);
+			max = std::max(max, loop[i]);
+		}
+
+		b2ChainShape chain;
+		chain.CreateLoop(vertices.data(), (int32)vertices.size());
+
+		b2FixtureDef fixtureDef;
+		fixtureDef.shape = &chain;
 		fixtureDef.density = 1.0f;
 		fixtureDef.friction = 0.0f;
 		fixtureDef.restitution = 0.0f;
 
-		// Creates the fixture and assigns it to the body
 		instance->body->CreateFixture(&fixtureDef);
 	}
 
+	if (!loops.empty())
+	{
+		instance->position = (min + max) / 2.0f;
+		instance->size = (max - min) / 2.0f;
+	}
+
 	// Creates a new B2CustomUserData object and assigns the instance to the owner
 	B2CustomUserData* instanceUserData = new B2CustomUserData;
 	instanceUserData->owner = instance;
 
-	// Assigns the instanceUserData to the body's user data
 	instance->body->GetUserData().pointer = reinterpret_cast<uintptr_t>(instanceUserData);
 
-	// Returns the instance
 	return instance;
 }
 
@@ -358,6 +590,9 @@ GraphicDef createDefOf(GraphicEntity* entity)
 	// Assigns the size and position of the entity to the def object
 	def.size = entity->size;
 	def.position = entity->position;
+	def.texture = entity->textureName;
+	def.layer = entity->layer;
+	def.depth = entity->depth;
 
 	// Returns the def object
 	return def;
@@ -371,24 +606,18 @@ PhysicalDef createDefOf(PhysicalEntity* entity)
 	// Assigns the size and position of the entity to the def object
 	def.size = entity->size;
 	def.position = entity->position;
+	def.texture = entity->textureName;
+	def.layer = entity->layer;
+	def.depth = entity->depth;
 
 	// Assigns the body type of the entity to the def object
 	def.bodyType = entity->body->GetType();
 
-	// Assigns the fixture vertices of the entity to the def object
-	for (size_t i = 0; i < entity->shapes.size(); i++)
-	{
-		// Creates a vector of the vertices
-		std::vector<Vec2> vertices;
-
-		// Gets the true pointer of the shape
-		b2PolygonShape* shape = static_cast<b2PolygonShape*>(entity->shapes[i].get());
+	// Assigns the outlines of the hitboxes (as they were written, not the convex pieces) to the def object
+	def.fixtureVertices.reserve(entity->hitboxes.size());
 
-		for (int j = 0; j < shape->m_count; j++)
-			vertices.push_back(Vec2(shape->m_vertices[j]));
-
-		def.fixtureVertices.push_back(vertices);
-	}
+	for (const std::shared_ptr<const Hitbox>& hitbox : entity->hitboxes)
+		def.fixtureVertices.push_back(hitbox->outline);
 
 	// Returns the def object
 	return def;
@@ -0,0 +1,106 @@
+#include <engine/governor.h>
+
+// Weight of the newest frame in the smoothed frame time
+static constexpr float SMOOTHING = 0.2f;
+
+FrameGovernor::FrameGovernor()
+{
+	// Full quality
+	levels.push_back(QualityLevel());
+
+	// Drops the debug drawing and a few solver iterations
+	QualityLevel reduced;
+	reduced.velocityIterations = 6;
+	reduced.positionIterations = 2;
+	reduced.debugDrawing = false;
+	levels.push_back(reduced);
+
+	// Drops the post processing and halves the step rate of far bodies
+	QualityLevel low = reduced;
+	low.velocityIterations = 4;
+	low.postProcess = false;
+	low.farUpdateInterval = 2;
+	levels.push_back(low);
+
+	// The least the engine can do while still keeping stacks standing
+	QualityLevel minimum = low;
+	minimum.velocityIterations = 3;
+	minimum.positionIterations = 1;
+	minimum.farUpdateInterval = 4;
+	levels.push_back(minimum);
+}
+
+bool FrameGovernor::addFrame(float frameMs)
+{
+	// Starts the average at the first frame instead of zero
+	smoothedMs = (smoothedMs == 0.0f) ? frameMs : smoothedMs + (frameMs - smoothedMs) * SMOOTHING;
+
+	if (!enabled)
+		return false;
+
+	// Counts how long the frames have been over or well under budget
+	if (smoothedMs > budgetMs)
+	{
+		overBudgetFrames++;
+		underBudgetFrames = 0;
+	}
+
+	else if (smoothedMs < budgetMs * GOVERNOR_UPGRADE_HEADROOM)
+	{
+		underBudgetFrames++;
+		overBudgetFrames = 0;
+	}
+
+	else
+	{
+		overBudgetFrames = 0;
+		underBudgetFrames = 0;
+	}
+
+	// Drops a level quickly so frames are not missed
+	if (overBudgetFrames >= GOVERNOR_DOWNGRADE_FRAMES && level + 1 < levels.size())
+	{
+		level++;
+		overBudgetFrames = 0;
+
+		// Measures the new level from scratch so the frames before the change do not drop it again
+		smoothedMs = 0.0f;
+
+		return true;
+	}
+
+	// Only raises a level once the headroom has lasted
+	if (underBudgetFrames >= GOVERNOR_UPGRADE_FRAMES && level > 0)
+	{
+		level--;
+		underBudgetFrames = 0;
+		smoothedMs = 0.0f;
+
+		return true;
+	}
+
+	return false;
+}
+
+void FrameGovernor::setLevels(const std::vector<QualityLevel>& newLevels)
+{
+	if (newLevels.empty())
+		throw std::runtime_error("Error: a frame governor needs at least one quality level");
+
+	levels = newLevels;
+	level = 0;
+
+	overBudgetFrames = 0;
+	underBudgetFrames = 0;
+}
+
+void FrameGovernor::setEnabled(bool isEnabled)
+{
+	enabled = isEnabled;
+
+	if (!enabled)
+		level = 0;
+
+	overBudgetFrames = 0;
+	underBudgetFrames = 0;
+}
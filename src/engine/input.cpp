@@ -0,0 +1,182 @@
+#include <engine/input.h>
+
+#include <algorithm>
+
+void InputState::beginPoll(Clock::time_point time)
+{
+	// The first poll has nothing before it so its events are counted from the poll itself
+	previousPoll = (lastPoll == Clock::time_point()) ? time : lastPoll;
+	lastPoll = time;
+}
+
+bool InputState::handleEvent(const sf::Event& event)
+{
+	switch (event.type)
+	{
+		case sf::Event::KeyPressed:
+			// Ignores keys SFML does not know and the repeats sent while a key is held
+			if (event.key.code < 0 || event.key.code >= sf::Keyboard::KeyCount || keyDown[event.key.code])
+				return true;
+
+			keyDown[event.key.code] = true;
+			keyLatched[event.key.code] = true;
+			pendingPresses.push_back(previousPoll);
+			return true;
+
+		case sf::Event::KeyReleased:
+			if (event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount)
+				keyDown[event.key.code] = false;
+
+			return true;
+
+		case sf::Event::MouseButtonPressed:
+			if (event.mouseButton.button < 0 || event.mouseButton.button >= sf::Mouse::ButtonCount || buttonDown[event.mouseButton.button])
+				return true;
+
+			buttonDown[event.mouseButton.button] = true;
+			buttonLatched[event.mouseButton.button] = true;
+			pendingPresses.push_back(previousPoll);
+			return true;
+
+		case sf::Event::MouseButtonReleased:
+			if (event.mouseButton.button >= 0 && event.mouseButton.button < sf::Mouse::ButtonCount)
+				buttonDown[event.mouseButton.button] = false;
+
+			return true;
+
+		case sf::Event::LostFocus:
+			releaseAll();
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void InputState::releaseAll()
+{
+	keyDown.fill(false);
+	buttonDown.fill(false);
+}
+
+void InputState::endFrame(bool advanceCounters)
+{
+	if (advanceCounters)
+	{
+		// A key counts as held this frame if it is down or was pressed at any point since the last frame
+		for (size_t i = 0; i < keyFrames.size(); i++)
+			advance(keyFrames[i], keyDown[i] || keyLatched[i]);
+
+		for (size_t i = 0; i < buttonFrames.size(); i++)
+			advance(buttonFrames[i], buttonDown[i] || buttonLatched[i]);
+	}
+
+	keyLatched.fill(false);
+	buttonLatched.fill(false);
+}
+
+void InputState::onStep()
+{
+	steppedPresses.insert(steppedPresses.end(), pendingPresses.begin(), pendingPresses.end());
+	pendingPresses.clear();
+}
+
+void InputState::onDisplay(Clock::time_point time)
+{
+	for (Clock::time_point pressTime : steppedPresses)
+	{
+		float latency = std::chrono::duration<float, std::milli>(time - pressTime).count();
+
+		latencyHistory[latencyCount % LATENCY_HISTORY] = latency;
+		latencyCount++;
+		latencyTotal = latencyTotal + latency;
+		latencyMax = std::max(latencyMax, latency);
+	}
+
+	steppedPresses.clear();
+}
+
+const InputState::ActionBinding& InputState::getAction(const std::string& action) const
+{
+	auto found = actions.find(action);
+
+	if (found == actions.end())
+		throw std::runtime_error("Error: input action " + action + " does not exist");
+
+	return found->second;
+}
+
+void InputState::bindAction(const std::string& action, sf::Keyboard::Key key)
+{
+	if (key < 0 || key >= sf::Keyboard::KeyCount)
+		throw std::runtime_error("Error: cannot bind an unknown key to input action " + action);
+
+	std::vector<sf::Keyboard::Key>& keys = actions[action].keys;
+
+	if (std::find(keys.begin(), keys.end(), key) == keys.end())
+		keys.push_back(key);
+}
+
+void InputState::bindAction(const std::string& action, sf::Mouse::Button button)
+{
+	if (button < 0 || button >= sf::Mouse::ButtonCount)
+		throw std::runtime_error("Error: cannot bind an unknown mouse button to input action " + action);
+
+	std::vector<sf::Mouse::Button>& buttons = actions[action].buttons;
+
+	if (std::find(buttons.begin(), buttons.end(), button) == buttons.end())
+		buttons.push_back(button);
+}
+
+long InputState::getActionInfo(const std::string& action) const
+{
+	const ActionBinding& binding = getAction(action);
+
+	// Held bindings beat released ones, otherwise the one released most recently wins
+	long result = 0;
+
+	auto combine = [&result](long frames)
+	{
+		if (frames > 0)
+			result = std::max(result, frames);
+
+		else if (frames < 0 && result <= 0)
+			result = result == 0 ? frames : std::max(result, frames);
+	};
+
+	for (sf::Keyboard::Key key : binding.keys)
+		combine(keyFrames[key]);
+
+	for (sf::Mouse::Button button : binding.buttons)
+		combine(buttonFrames[button]);
+
+	return result;
+}
+
+InputLatencyStats InputState::getLatencyStats() const
+{
+	InputLatencyStats stats;
+	stats.samples = latencyCount;
+
+	if (latencyCount == 0)
+		return stats;
+
+	stats.meanMs = (float)(latencyTotal / (double)latencyCount);
+	stats.maxMs = latencyMax;
+
+	// The 95th percentile is taken from the most recent samples only
+	std::vector<float> recent(latencyHistory.begin(), latencyHistory.begin() + std::min(latencyCount, LATENCY_HISTORY));
+
+	size_t index = std::min((size_t)(0.95f * (float)recent.size()), recent.size() - 1);
+	std::nth_element(recent.begin(), recent.begin() + index, recent.end());
+	stats.p95Ms = recent[index];
+
+	return stats;
+}
+
+void InputState::resetLatencyStats()
+{
+	latencyCount = 0;
+	latencyTotal = 0.0;
+	latencyMax = 0.0f;
+}
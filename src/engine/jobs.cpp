@@ -0,0 +1,358 @@
+#include <engine/jobs.h>
+
+#include <algorithm>
+
+// Queue of the worker the current thread is (0 for threads outside of any pool)
+static thread_local size_t currentQueue = 0;
+
+// Pool the current thread is a worker of
+static thread_local const JobSystem* currentPool = nullptr;
+
+JobSystem::JobSystem(size_t workerCount)
+{
+	// Leaves one core for the thread that submits the jobs
+	if (workerCount == 0)
+		workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	for (size_t i = 0; i < workerCount + 1; i++)
+		queues.push_back(std::make_unique<JobQueue>());
+
+	for (size_t i = 0; i < workerCount; i++)
+		workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+void JobSystem::shutdown()
+{
+	if (stopping)
+		return;
+
+	// Helps until nothing is queued or running. A running job can still queue the jobs that depend on it, so the
+	// queues being empty is not enough (queued is read first as a job counts as running before it leaves the queue)
+	while (queuedCount.load() != 0 || runningCount.load() != 0)
+		helpOrYield(0);
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+
+	wake.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	workers.clear();
+}
+
+void JobSystem::push(Job job)
+{
+	if (stopping)
+		throw std::runtime_error("Error: cannot add a job after the job system has shut down");
+
+	// Workers add to their own queue, other threads spread their jobs over all the queues
+	size_t index = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+
+	{
+		JobQueue& queue = *queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+		queuedCount++;
+	}
+
+	// Takes the lock so a worker cannot miss the wake up between checking the count and sleeping
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+
+	wake.notify_one();
+}
+
+bool JobSystem::takeJob(size_t ownQueue, Job& job)
+{
+	if (queuedCount.load(std::memory_order_acquire) == 0)
+		return false;
+
+	// Newest job of its own queue
+	{
+		JobQueue& queue = *queues[ownQueue];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			runningCount++;
+			queuedCount--;
+			return true;
+		}
+	}
+
+	// Oldest job of any other queue (starting after its own so the workers do not all steal from the same one)
+	for (size_t i = 1; i < queues.size(); i++)
+	{
+		JobQueue& queue = *queues[(ownQueue + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			runningCount++;
+			queuedCount--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::runJob(Job& job)
+{
+	// Jobs scheduled with dependencies handle their own exceptions
+	if (job.group == nullptr)
+		job.function();
+
+	else
+	{
+		try
+		{
+			job.function();
+		}
+
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(job.group->errorMutex);
+
+			if (job.group->error == nullptr)
+				job.group->error = std::current_exception();
+		}
+
+		job.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	// Only after the job has queued anything it released (see shutdown)
+	runningCount--;
+}
+
+size_t JobSystem::getOwnQueue() const
+{
+	return currentPool == this ? currentQueue : 0;
+}
+
+void JobSystem::helpOrYield(size_t ownQueue)
+{
+	Job job;
+
+	if (takeJob(ownQueue, job))
+		runJob(job);
+
+	else
+		std::this_thread::yield();
+}
+
+void JobSystem::workerLoop(size_t index)
+{
+	currentQueue = index;
+	currentPool = this;
+
+	while (true)
+	{
+		Job job;
+
+		if (takeJob(index, job))
+		{
+			runJob(job);
+			continue;
+		}
+
+		// Sleeps until there is work or the pool is stopping
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this]() { return stopping || queuedCount.load() != 0; });
+
+		if (stopping && queuedCount.load() == 0)
+			return;
+	}
+}
+
+void JobSystem::submit(JobGroup& group, std::function<void()> function)
+{
+	group.pending.fetch_add(1, std::memory_order_relaxed);
+
+	try
+	{
+		push({ std::move(function), &group });
+	}
+
+	catch (...)
+	{
+		group.pending.fetch_sub(1, std::memory_order_relaxed);
+		throw;
+	}
+}
+
+void JobSystem::wait(JobGroup& group)
+{
+	size_t ownQueue = getOwnQueue();
+
+	// Helps with any queued job (not only the group's) until the group is done
+	while (!group.isDone())
+		helpOrYield(ownQueue);
+
+	// Rethrows the first exception of the group (once)
+	std::exception_ptr error;
+
+	{
+		std::lock_guard<std::mutex> lock(group.errorMutex);
+		std::swap(error, group.error);
+	}
+
+	if (error != nullptr)
+		std::rethrow_exception(error);
+}
+
+void JobSystem::enqueueReady(const std::shared_ptr<JobHandle::State>& state)
+{
+	push({ [this, state]() { runScheduled(state); }, nullptr });
+}
+
+void JobSystem::runScheduled(const std::shared_ptr<JobHandle::State>& state)
+{
+	// Skipped if a dependency threw (the exception was passed on when it finished)
+	if (state->error == nullptr)
+	{
+		try
+		{
+			state->function();
+		}
+
+		catch (...)
+		{
+			state->error = std::current_exception();
+		}
+	}
+
+	// Frees whatever the function captured as nothing will call it again
+	state->function = nullptr;
+
+	// Marks the job as finished and takes the jobs waiting for it
+	std::vector<std::shared_ptr<JobHandle::State>> dependents;
+
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->finished.store(true, std::memory_order_release);
+		std::swap(dependents, state->dependents);
+	}
+
+	// Queues the dependents that were only waiting for this job
+	for (const std::shared_ptr<JobHandle::State>& dependent : dependents)
+	{
+		if (state->error != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(dependent->mutex);
+
+			if (dependent->error == nullptr)
+				dependent->error = state->error;
+		}
+
+		if (dependent->waitingOn.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			enqueueReady(dependent);
+	}
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function, const std::vector<JobHandle>& dependencies)
+{
+	std::shared_ptr<JobHandle::State> state = std::make_shared<JobHandle::State>();
+	state->function = std::move(function);
+
+	// Registers with every dependency that has not finished yet (waitingOn starts at one so the job cannot start mid way)
+	for (const JobHandle& dependency : dependencies)
+	{
+		if (dependency.state == nullptr)
+			continue;
+
+		std::lock_guard<std::mutex> lock(dependency.state->mutex);
+
+		if (!dependency.state->finished.load(std::memory_order_acquire))
+		{
+			state->waitingOn.fetch_add(1, std::memory_order_relaxed);
+			dependency.state->dependents.push_back(state);
+		}
+
+		else if (dependency.state->error != nullptr)
+		{
+			std::lock_guard<std::mutex> stateLock(state->mutex);
+
+			if (state->error == nullptr)
+				state->error = dependency.state->error;
+		}
+	}
+
+	// Drops the extra count, queueing the job if every dependency has already finished
+	if (state->waitingOn.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		enqueueReady(state);
+
+	return JobHandle(state);
+}
+
+void JobSystem::wait(const JobHandle& handle)
+{
+	if (handle.state == nullptr)
+		return;
+
+	size_t ownQueue = getOwnQueue();
+
+	while (!handle.isDone())
+		helpOrYield(ownQueue);
+
+	if (handle.state->error != nullptr)
+		std::rethrow_exception(handle.state->error);
+}
+
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t grainSize)
+{
+	if (count == 0)
+		return;
+
+	// A few chunks per thread so the threads that finish early can steal the rest
+	if (grainSize == 0)
+		grainSize = std::max(count / ((workers.size() + 1) * 4), (size_t)1);
+
+	// Small ranges are not worth queueing
+	if (count <= grainSize || workers.empty())
+	{
+		function(0, count);
+		return;
+	}
+
+	JobGroup group;
+
+	// Queues every chunk but the first which this thread runs
+	for (size_t begin = grainSize; begin < count; begin += grainSize)
+	{
+		size_t end = std::min(begin + grainSize, count);
+		submit(group, [&function, begin, end]() { function(begin, end); });
+	}
+
+	std::exception_ptr error;
+
+	try
+	{
+		function(0, grainSize);
+	}
+
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	// The chunks use the group and the function so they are always waited for
+	wait(group);
+
+	if (error != nullptr)
+		std::rethrow_exception(error);
+}
@@ -1,136 +1,137 @@
 #include <engine/level.h>
 
+#include <engine/levelBinary.h>
 #include <engine/entity.h>
 
-static void parseGraphicEntitiesJSON(const nl::json& levelJson, LevelDef& def)
+LevelDef loadLevelDef(const std::string& levelPath)
 {
-	// Checks that graphicEntities is an array
-	if (!levelJson["graphicEntities"].is_array())
-		throw std::runtime_error("Error: graphicEntities is not an array in JSON file");
+	// Reads binary levels in place instead of parsing them
+	if (isBinaryLevel(levelPath))
+		return loadBinaryLevelDef(levelPath);
 
-	// Loops through each graphic entity
-	for (const auto& currentDef : levelJson["graphicEntities"])
-	{
-		// Adds a new GraphicDef to the vector
-		def.graphicEntities.push_back(GraphicDef());
+	// Creates a new LevelDef
+	LevelDef def;
 
-		// Gets a reference to the last element in the vector
-		GraphicDef& defRef = def.graphicEntities.back();
+	// Streams each entity straight into the LevelDef (the JSON document is never fully in memory)
+	streamLevelDef(levelPath,
+		[&def](const GraphicDef& graphicDef) { def.graphicEntities.push_back(graphicDef); },
+		[&def](const PhysicalDef& physicalDef) { def.physicalEntities.push_back(physicalDef); }
+	);
 
-		// Sets the size and position of the GraphicDef
-		defRef.size = currentDef["size"].get<Vec2>();
-		defRef.position = currentDef["position"].get<Vec2>();
-	}
+	// Returns the LevelDef
+	return def;
 }
 
-static void parsePhysicalEntitiesJSON(const nl::json& levelJson, LevelDef& def)
+size_t estimateMemory(const LevelDef& levelDef)
 {
-	// Checks that physicalEntities is an array
-	if (!levelJson["physicalEntities"].is_array())
-		throw std::runtime_error("Error: physicalEntities is not an array in JSON file");
-
-	// Loops through each physical entity
-	for (const auto& currentDef : levelJson["physicalEntities"])
-	{
-		// Adds a new PhysicalDef to the vector
-		def.physicalEntities.push_back(PhysicalDef());
+	// The def arrays themselves
+	size_t bytes = levelDef.graphicEntities.capacity() * sizeof(GraphicDef) + levelDef.physicalEntities.capacity() * sizeof(PhysicalDef);
 
-		// Gets a reference to the last element in the vector
-		PhysicalDef& defRef = def.physicalEntities.back();
+	// Texture names too long for the small string buffer
+	for (const GraphicDef& def : levelDef.graphicEntities)
+		bytes += def.texture.capacity();
 
-		// Sets the size and position of the PhysicalDef
-		defRef.size = currentDef["size"].get<Vec2>();
-		defRef.position = currentDef["position"].get<Vec2>();
-
-		// Converts the bodyType from a string to a b2BodyType
-		defRef.bodyType = convertFromStr(currentDef["bodyType"].get<std::string>());
+	for (const PhysicalDef& def : levelDef.physicalEntities)
+	{
+		bytes += def.texture.capacity();
+		bytes += def.fixtureVertices.capacity() * sizeof(std::vector<Vec2>);
 
-		// Checks if the hitboxes array exists
-		if (currentDef.contains("hitboxes"))
-		{
-			// Checks that hitboxes is an array
-			if (!currentDef["hitboxes"].is_array())
-				throw std::runtime_error("Error: hitboxes is not an array in JSON file");
-
-			// Loops through each hitbox
-			for (const auto& hitbox : currentDef["hitboxes"])
-			{
-				// Checks that the hitbox is an array
-				if (!hitbox.is_array())
-					throw std::runtime_error("Error: hitbox is not an array in JSON file");
-
-				// Creates a vector of Vec2s
-				std::vector<Vec2> vertices;
-
-				// Loops through each vertex in the hitbox
-				for (const auto& vertex : hitbox)
-					vertices.push_back(vertex.get<Vec2>());
-
-				// Adds the vertices to the PhysicalDef
-				defRef.fixtureVertices.push_back(vertices);
-			}
-		}
+		// Vertices of every fixture
+		for (const std::vector<Vec2>& vertices : def.fixtureVertices)
+			bytes += vertices.capacity() * sizeof(Vec2);
 	}
+
+	return bytes;
 }
 
-LevelDef loadLevelDef(const std::string& levelPath)
+/*
+* @brief Removes every entity of a level that failed part way through being created
+*/
+static void removeLevel(const Level& level)
 {
-	// Opens the file
-	std::ifstream file(levelPath);
-
-	// Checks if the file is open
-	if (!file.is_open())
-		throw std::runtime_error("Error: could not open file " + levelPath);
+	std::unordered_set<Entity*> created;
+	created.insert(level.graphicEntities.begin(), level.graphicEntities.end());
+	created.insert(level.physicalEntities.begin(), level.physicalEntities.end());
+	created.insert(level.staticChains.begin(), level.staticChains.end());
 
-	// Loads file into a JSON object
-	nl::json levelJson;
-	file >> levelJson;
-
-	// Closes the file
-	file.close();
-
-	// Creates a new LevelDef
-	LevelDef def;
-
-	// Parses the graphic entities if they exist
-	if (levelJson.contains("graphicEntities"))
-		parseGraphicEntitiesJSON(levelJson, def);
-
-	// Parses the physical entities if they exist
-	if (levelJson.contains("physicalEntities"))
-		parsePhysicalEntitiesJSON(levelJson, def);
-
-	// Returns the LevelDef
-	return def;
+	Entity::remove(created);
 }
 
-Level loadLevel(const LevelDef& levelDef)
+Level loadLevel(const LevelDef& levelDef, const LevelLoadOptions& options)
 {
 	// Creates a new LevelPtrs
 	Level level;
 
+	// Finds the static boxes that will be replaced by chains
+	std::vector<StaticBoxGroup> groups;
+	std::vector<bool> merged(levelDef.physicalEntities.size(), false);
+
+	if (options.mergeStaticBoxes)
+	{
+		groups = findStaticBoxGroups(levelDef);
+
+		for (const StaticBoxGroup& group : groups)
+		{
+			for (size_t index : group.defIndices)
+				merged[index] = true;
+		}
+	}
+
+	// Makes space for every entity at once
+	Entity::reserve(levelDef.graphicEntities.size() + levelDef.physicalEntities.size() + groups.size());
+	level.graphicEntities.reserve(levelDef.graphicEntities.size());
+	level.physicalEntities.reserve(levelDef.physicalEntities.size());
+
 	// Loads the graphic entities
 	for (auto& def : levelDef.graphicEntities)
 		level.graphicEntities.push_back(GraphicEntity::create(def));
 
-	// Loads the physical entities
-	for (auto& def : levelDef.physicalEntities)
-		level.physicalEntities.push_back(PhysicalEntity::create(def));
+	// Loads the physical entities (merged boxes are created without fixtures)
+	for (size_t i = 0; i < levelDef.physicalEntities.size(); i++)
+		level.physicalEntities.push_back(PhysicalEntity::create(levelDef.physicalEntities[i], !merged[i]));
+
+	// Creates a body for each group of merged boxes
+	for (const StaticBoxGroup& group : groups)
+		level.staticChains.push_back(StaticChainEntity::create(group.loops));
 
 	// Returns the LevelPtrs
 	return level;
 }
 
-Level loadLevel(const std::string& levelPath)
+Level loadLevel(const std::string& levelPath, const LevelLoadOptions& options)
 {
-	// Loads the LevelDef from the JSON file
-	LevelDef def = loadLevelDef(levelPath);
+	// Merging needs every def at once
+	if (options.mergeStaticBoxes)
+		return loadLevel(loadLevelDef(levelPath), options);
+
+	// Creates the entities straight from the mapped file if it is a binary level
+	if (isBinaryLevel(levelPath))
+		return loadLevel(BinaryLevel(levelPath));
+
+	// Creates a new LevelPtrs
+	Level level;
+
+	// Creates each entity as soon as it has been parsed so only one def is in memory at a time
+	try
+	{
+		streamLevelDef(levelPath,
+			[&level](const GraphicDef& def) { level.graphicEntities.push_back(GraphicEntity::create(def)); },
+			[&level](const PhysicalDef& def) { level.physicalEntities.push_back(PhysicalEntity::create(def)); }
+		);
+	}
+
+	// An error late in the file removes the entities already created so a bad file leaves the world untouched
+	catch (...)
+	{
+		removeLevel(level);
+		throw;
+	}
 
 	// Returns the LevelPtrs
-	return loadLevel(def);
+	return level;
 }
 
-static void saveGraphicEntity(GraphicDef entityDef, nl::json& levelJson)
+static nl::json graphicEntityJson(const GraphicDef& entityDef)
 {
 	// Creates a JSON object for the entity
 	nl::json entityJson;
@@ -139,18 +140,24 @@ static void saveGraphicEntity(GraphicDef entityDef, nl::json& levelJson)
 	entityJson["size"] = entityDef.size;
 	entityJson["position"] = entityDef.position;
 
-	// Adds the entity to the level JSON
-	levelJson["graphicEntities"].push_back(entityJson);
+	// Only saves the texture if the entity has one
+	if (!entityDef.texture.empty())
+		entityJson["texture"] = entityDef.texture;
+
+	// Only saves the draw order if it is not the default
+	if (entityDef.layer != 0)
+		entityJson["layer"] = entityDef.layer;
+
+	if (entityDef.depth != 0.0f)
+		entityJson["depth"] = entityDef.depth;
+
+	return entityJson;
 }
 
-static void savePhysicalEntity(PhysicalDef entityDef, nl::json& levelJson)
+static nl::json physicalEntityJson(const PhysicalDef& entityDef)
 {
-	// Creates a JSON object for the entity
-	nl::json entityJson;
-
-	// Sets the size and position of the entity
-	entityJson["size"] = entityDef.size;
-	entityJson["position"] = entityDef.position;
+	// Starts with the GraphicDef part of the entity
+	nl::json entityJson = graphicEntityJson(entityDef);
 
 	// Converts the bodyType to a string
 	entityJson["bodyType"] = convertToStr(entityDef.bodyType);
@@ -169,8 +176,25 @@ static void savePhysicalEntity(PhysicalDef entityDef, nl::json& levelJson)
 		entityJson["hitboxes"].push_back(hitboxJson);
 	}
 
-	// Adds the entity to the level JSON
-	levelJson["physicalEntities"].push_back(entityJson);
+	return entityJson;
+}
+
+std::string entityToJson(const GraphicDef& def)
+{
+	return graphicEntityJson(def).dump(-1);
+}
+
+std::string entityToJson(const PhysicalDef& def)
+{
+	return physicalEntityJson(def).dump(-1);
+}
+
+static void writeJson(const nl::json& levelJson, const std::string& filePath)
+{
+	// Dumps the JSON object to the file
+	std::ofstream file(filePath);
+	file << levelJson.dump(-1);
+	file.close();
 }
 
 void saveToJson(Level& level, const std::string& filePath)
@@ -180,14 +204,26 @@ void saveToJson(Level& level, const std::string& filePath)
 
 	// Iterates through each graphic entity and saves it
 	for (GraphicEntity* entity : level.graphicEntities)
-		saveGraphicEntity(createDefOf(entity), levelJson);
+		levelJson["graphicEntities"].push_back(graphicEntityJson(createDefOf(entity)));
 
 	// Iterates through each physical entity and saves it
 	for (PhysicalEntity* entity : level.physicalEntities)
-		savePhysicalEntity(createDefOf(entity), levelJson);
+		levelJson["physicalEntities"].push_back(physicalEntityJson(createDefOf(entity)));
 
-	// Dumps the JSON object to the file
-	std::ofstream file(filePath);
-	file << levelJson.dump(-1);
-	file.close();
+	writeJson(levelJson, filePath);
+}
+
+void saveToJson(const LevelDef& levelDef, const std::string& filePath)
+{
+	// Creates a JSON object
+	nl::json levelJson;
+
+	// Iterates through each def and saves it
+	for (const GraphicDef& def : levelDef.graphicEntities)
+		levelJson["graphicEntities"].push_back(graphicEntityJson(def));
+
+	for (const PhysicalDef& def : levelDef.physicalEntities)
+		levelJson["physicalEntities"].push_back(physicalEntityJson(def));
+
+	writeJson(levelJson, filePath);
 }
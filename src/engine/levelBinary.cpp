@@ -0,0 +1,270 @@
+#include <engine/levelBinary.h>
+
+#include <engine/entity.h>
+
+#include <cstring>
+
+// The records are read straight out of the file so their layout must never change without changing the version
+static_assert(sizeof(BinaryLevelHeader) == 52, "BinaryLevelHeader layout changed");
+static_assert(sizeof(BinaryGraphicRecord) == 32, "BinaryGraphicRecord layout changed");
+static_assert(sizeof(BinaryPhysicalRecord) == 44, "BinaryPhysicalRecord layout changed");
+static_assert(sizeof(BinaryHitboxRecord) == 8, "BinaryHitboxRecord layout changed");
+static_assert(sizeof(BinaryVertex) == 8, "BinaryVertex layout changed");
+
+static const char BINARY_LEVEL_MAGIC[4] = { 'B', '2', 'L', 'V' };
+
+// --------------- Reading --------------- //
+
+template<typename RECORD>
+static const RECORD* getSection(const MappedFile& file, uint32_t offset, uint32_t count, const std::string& levelPath)
+{
+	// Checks the section is aligned and fully inside of the file
+	if (offset % 4 != 0 || (uint64_t)offset + (uint64_t)count * sizeof(RECORD) > file.getSize())
+		throw std::runtime_error("Error: binary level " + levelPath + " is corrupt");
+
+	return reinterpret_cast<const RECORD*>(file.getData() + offset);
+}
+
+BinaryLevel::BinaryLevel(const std::string& levelPath) : file(levelPath)
+{
+	// Checks the header fits in the file
+	if (file.getSize() < sizeof(BinaryLevelHeader))
+		throw std::runtime_error("Error: " + levelPath + " is not a binary level");
+
+	header = reinterpret_cast<const BinaryLevelHeader*>(file.getData());
+
+	// Checks the magic number, version and size
+	if (std::memcmp(header->magic, BINARY_LEVEL_MAGIC, 4) != 0)
+		throw std::runtime_error("Error: " + levelPath + " is not a binary level");
+
+	if (header->version != BINARY_LEVEL_VERSION)
+		throw std::runtime_error("Error: binary level " + levelPath + " has version " + std::to_string(header->version) + " but version " + std::to_string(BINARY_LEVEL_VERSION) + " is needed");
+
+	if (header->fileSize != file.getSize())
+		throw std::runtime_error("Error: binary level " + levelPath + " is truncated");
+
+	// Gets each section
+	graphics = getSection<BinaryGraphicRecord>(file, header->graphicOffset, header->graphicCount, levelPath);
+	physicals = getSection<BinaryPhysicalRecord>(file, header->physicalOffset, header->physicalCount, levelPath);
+	hitboxes = getSection<BinaryHitboxRecord>(file, header->hitboxOffset, header->hitboxCount, levelPath);
+	vertices = getSection<BinaryVertex>(file, header->vertexOffset, header->vertexCount, levelPath);
+	strings = getSection<char>(file, header->stringOffset, header->stringBytes, levelPath);
+
+	// Checks every index and string offset is in range so the records can be read without checks later
+	auto checkGraphic = [&](const BinaryGraphicRecord& record)
+	{
+		if ((uint64_t)record.textureOffset + record.textureLength > header->stringBytes)
+			throw std::runtime_error("Error: binary level " + levelPath + " is corrupt");
+	};
+
+	for (uint32_t i = 0; i < header->graphicCount; i++)
+		checkGraphic(graphics[i]);
+
+	for (uint32_t i = 0; i < header->physicalCount; i++)
+	{
+		checkGraphic(physicals[i].graphic);
+
+		if ((uint64_t)physicals[i].firstHitbox + physicals[i].hitboxCount > header->hitboxCount || physicals[i].bodyType > b2_dynamicBody)
+			throw std::runtime_error("Error: binary level " + levelPath + " is corrupt");
+	}
+
+	for (uint32_t i = 0; i < header->hitboxCount; i++)
+	{
+		if ((uint64_t)hitboxes[i].firstVertex + hitboxes[i].vertexCount > header->vertexCount)
+			throw std::runtime_error("Error: binary level " + levelPath + " is corrupt");
+	}
+}
+
+void BinaryLevel::readGraphic(const BinaryGraphicRecord& record, GraphicDef& def) const
+{
+	def.size = Vec2(record.sizeX, record.sizeY);
+	def.position = Vec2(record.positionX, record.positionY);
+	def.layer = record.layer;
+	def.depth = record.depth;
+	def.texture.assign(strings + record.textureOffset, record.textureLength);
+}
+
+void BinaryLevel::getGraphicDef(size_t index, GraphicDef& def) const
+{
+	readGraphic(graphics[index], def);
+}
+
+void BinaryLevel::getPhysicalDef(size_t index, PhysicalDef& def) const
+{
+	const BinaryPhysicalRecord& record = physicals[index];
+
+	readGraphic(record.graphic, def);
+	def.bodyType = (b2BodyType)record.bodyType;
+
+	// Copies the hitboxes (resizing keeps the memory of the inner vectors when the def is reused)
+	def.fixtureVertices.resize(record.hitboxCount);
+
+	for (uint32_t i = 0; i < record.hitboxCount; i++)
+	{
+		const BinaryHitboxRecord& hitbox = hitboxes[record.firstHitbox + i];
+		std::vector<Vec2>& outline = def.fixtureVertices[i];
+
+		outline.resize(hitbox.vertexCount);
+
+		for (uint32_t j = 0; j < hitbox.vertexCount; j++)
+			outline[j] = Vec2(vertices[hitbox.firstVertex + j].x, vertices[hitbox.firstVertex + j].y);
+	}
+}
+
+bool isBinaryLevel(const std::string& levelPath)
+{
+	// Reads just the magic number
+	std::ifstream file(levelPath, std::ios::binary);
+
+	char magic[4] = {};
+	file.read(magic, 4);
+
+	return file.gcount() == 4 && std::memcmp(magic, BINARY_LEVEL_MAGIC, 4) == 0;
+}
+
+LevelDef loadBinaryLevelDef(const std::string& levelPath)
+{
+	BinaryLevel binaryLevel(levelPath);
+
+	// Creates a new LevelDef with space for every entity
+	LevelDef def;
+	def.graphicEntities.resize(binaryLevel.getGraphicCount());
+	def.physicalEntities.resize(binaryLevel.getPhysicalCount());
+
+	// Reads every entity
+	for (size_t i = 0; i < def.graphicEntities.size(); i++)
+		binaryLevel.getGraphicDef(i, def.graphicEntities[i]);
+
+	for (size_t i = 0; i < def.physicalEntities.size(); i++)
+		binaryLevel.getPhysicalDef(i, def.physicalEntities[i]);
+
+	return def;
+}
+
+Level loadLevel(const BinaryLevel& binaryLevel)
+{
+	Level level;
+	Entity::reserve(binaryLevel.getGraphicCount() + binaryLevel.getPhysicalCount());
+	level.graphicEntities.reserve(binaryLevel.getGraphicCount());
+	level.physicalEntities.reserve(binaryLevel.getPhysicalCount());
+
+	// Reuses one def for every entity so only one entity is copied out of the file at a time
+	GraphicDef graphicDef;
+
+	for (size_t i = 0; i < binaryLevel.getGraphicCount(); i++)
+	{
+		binaryLevel.getGraphicDef(i, graphicDef);
+		level.graphicEntities.push_back(GraphicEntity::create(graphicDef));
+	}
+
+	PhysicalDef physicalDef;
+
+	for (size_t i = 0; i < binaryLevel.getPhysicalCount(); i++)
+	{
+		binaryLevel.getPhysicalDef(i, physicalDef);
+		level.physicalEntities.push_back(PhysicalEntity::create(physicalDef));
+	}
+
+	return level;
+}
+
+// --------------- Writing --------------- //
+
+static BinaryGraphicRecord makeGraphicRecord(const GraphicDef& def, std::string& strings)
+{
+	BinaryGraphicRecord record;
+	record.sizeX = def.size.x;
+	record.sizeY = def.size.y;
+	record.positionX = def.position.x;
+	record.positionY = def.position.y;
+	record.layer = def.layer;
+	record.depth = def.depth;
+
+	// Adds the texture name to the string table
+	record.textureOffset = (uint32_t)strings.size();
+	record.textureLength = (uint32_t)def.texture.size();
+	strings += def.texture;
+
+	return record;
+}
+
+template<typename RECORD>
+static void writeSection(std::ofstream& file, const std::vector<RECORD>& records)
+{
+	file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(RECORD));
+}
+
+void saveToBinary(const LevelDef& levelDef, const std::string& levelPath)
+{
+	std::vector<BinaryGraphicRecord> graphics;
+	std::vector<BinaryPhysicalRecord> physicals;
+	std::vector<BinaryHitboxRecord> hitboxes;
+	std::vector<BinaryVertex> vertices;
+	std::string strings;
+
+	// Flattens the graphic entities
+	graphics.reserve(levelDef.graphicEntities.size());
+
+	for (const GraphicDef& def : levelDef.graphicEntities)
+		graphics.push_back(makeGraphicRecord(def, strings));
+
+	// Flattens the physical entities and their hitboxes
+	physicals.reserve(levelDef.physicalEntities.size());
+
+	for (const PhysicalDef& def : levelDef.physicalEntities)
+	{
+		BinaryPhysicalRecord record;
+		record.graphic = makeGraphicRecord(def, strings);
+		record.bodyType = (uint32_t)def.bodyType;
+		record.firstHitbox = (uint32_t)hitboxes.size();
+		record.hitboxCount = (uint32_t)def.fixtureVertices.size();
+
+		for (const std::vector<Vec2>& outline : def.fixtureVertices)
+		{
+			hitboxes.push_back({ (uint32_t)vertices.size(), (uint32_t)outline.size() });
+
+			for (const Vec2& vertex : outline)
+				vertices.push_back({ vertex.x, vertex.y });
+		}
+
+		physicals.push_back(record);
+	}
+
+	// Pads the string table so the file size stays a multiple of 4
+	size_t stringBytes = strings.size();
+	strings.resize((strings.size() + 3) / 4 * 4, '\0');
+
+	// Lays the sections out one after another
+	BinaryLevelHeader header;
+	std::memcpy(header.magic, BINARY_LEVEL_MAGIC, 4);
+	header.version = BINARY_LEVEL_VERSION;
+
+	header.graphicCount = (uint32_t)graphics.size();
+	header.physicalCount = (uint32_t)physicals.size();
+	header.hitboxCount = (uint32_t)hitboxes.size();
+	header.vertexCount = (uint32_t)vertices.size();
+	header.stringBytes = (uint32_t)stringBytes;
+
+	header.graphicOffset = sizeof(BinaryLevelHeader);
+	header.physicalOffset = header.graphicOffset + header.graphicCount * sizeof(BinaryGraphicRecord);
+	header.hitboxOffset = header.physicalOffset + header.physicalCount * sizeof(BinaryPhysicalRecord);
+	header.vertexOffset = header.hitboxOffset + header.hitboxCount * sizeof(BinaryHitboxRecord);
+	header.stringOffset = header.vertexOffset + header.vertexCount * sizeof(BinaryVertex);
+	header.fileSize = header.stringOffset + (uint32_t)strings.size();
+
+	// Writes the file
+	std::ofstream file(levelPath, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		throw std::runtime_error("Error: could not open file " + levelPath);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeSection(file, graphics);
+	writeSection(file, physicals);
+	writeSection(file, hitboxes);
+	writeSection(file, vertices);
+	file.write(strings.data(), strings.size());
+
+	if (!file.good())
+		throw std::runtime_error("Error: could not write file " + levelPath);
+}
@@ -0,0 +1,117 @@
+#include <engine/levelLoad.h>
+
+LevelLoad::LevelLoad(const std::string& levelPath, std::function<void(Level&)> onComplete)
+	: levelPath(levelPath), onComplete(std::move(onComplete))
+{
+	// Reads and parses the file on a worker thread (this does not touch the b2World so it is safe off the main thread)
+	parsing = std::async(std::launch::async, [levelPath]() { return loadLevelDef(levelPath); });
+}
+
+bool LevelLoad::update(float budgetMs)
+{
+	if (complete)
+		return true;
+
+	// Waits for the worker thread without blocking the frame
+	if (!parsed)
+	{
+		if (parsing.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+
+		// get rethrows any error from the worker thread, which fails the load instead of throwing out of every frame
+		try
+		{
+			levelDef = parsing.get();
+		}
+
+		catch (const std::exception& error)
+		{
+			this->error = error.what();
+
+			// Keeps failed() true even for an exception with no message
+			if (this->error.empty())
+				this->error = "Error: could not load level " + levelPath;
+
+			std::cout << this->error << std::endl;
+			complete = true;
+
+			return true;
+		}
+
+		parsed = true;
+
+		defMemory.set(estimateMemory(levelDef));
+
+		level.graphicEntities.reserve(levelDef.graphicEntities.size());
+		level.physicalEntities.reserve(levelDef.physicalEntities.size());
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	// Returns true once the budget has been used up
+	auto outOfTime = [&]()
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs;
+	};
+
+	// Creates the graphic entities then the physical entities until the budget runs out
+	do
+	{
+		if (createdGraphic < levelDef.graphicEntities.size())
+			level.graphicEntities.push_back(GraphicEntity::create(levelDef.graphicEntities[createdGraphic++]));
+
+		else if (createdPhysical < levelDef.physicalEntities.size())
+		{
+			PhysicalEntity* entity = PhysicalEntity::create(levelDef.physicalEntities[createdPhysical++]);
+
+			// Keeps the body out of the simulation until the whole level exists so nothing falls through a floor that has not been created yet
+			entity->loading = true;
+
+			if (entity->body != nullptr)
+				entity->body->SetEnabled(false);
+
+			level.physicalEntities.push_back(entity);
+		}
+
+		else
+			break;
+	}
+	while (!outOfTime());
+
+	// Checks if every entity has been created
+	if (createdGraphic == levelDef.graphicEntities.size() && createdPhysical == levelDef.physicalEntities.size())
+	{
+		complete = true;
+
+		// Starts simulating every body of the level at once
+		for (PhysicalEntity* entity : level.physicalEntities)
+		{
+			entity->loading = false;
+
+			if (entity->body != nullptr)
+				entity->body->SetEnabled(true);
+		}
+
+		// Frees the defs as they are no longer needed
+		levelDef = LevelDef();
+		defMemory.set(0);
+
+		if (onComplete)
+			onComplete(level);
+	}
+
+	return complete;
+}
+
+float LevelLoad::getProgress() const
+{
+	if (complete)
+		return failed() ? 0.0f : 1.0f;
+
+	if (!parsed)
+		return 0.0f;
+
+	size_t total = levelDef.graphicEntities.size() + levelDef.physicalEntities.size();
+
+	return total == 0 ? 1.0f : (float)(createdGraphic + createdPhysical) / (float)total;
+}
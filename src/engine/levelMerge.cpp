@@ -0,0 +1,360 @@
+#include <engine/level.h>
+
+#include <engine/entity.h>
+
+#include <algorithm>
+
+// Largest grid a group of boxes can be traced on (groups spanning more cells are left unmerged)
+constexpr size_t MAX_MERGE_CELLS = 1 << 22;
+
+/*
+* @brief World space bounds of a static box
+*/
+struct MergeBox
+{
+	size_t defIndex;
+	float minX, minY, maxX, maxY;
+};
+
+/*
+* @brief Gets the world space bounds of a def if it is a static axis aligned box
+* 
+* @return False if the def can not be merged
+*/
+static bool getStaticBox(const PhysicalDef& def, size_t index, MergeBox& box)
+{
+	if (def.bodyType != b2_staticBody || def.fixtureVertices.size() != 1 || def.fixtureVertices[0].size() != 4)
+		return false;
+
+	const std::vector<Vec2>& vertices = def.fixtureVertices[0];
+
+	box = { index, vertices[0].x, vertices[0].y, vertices[0].x, vertices[0].y };
+
+	for (const Vec2& vertex : vertices)
+	{
+		box.minX = std::min(box.minX, vertex.x);
+		box.minY = std::min(box.minY, vertex.y);
+		box.maxX = std::max(box.maxX, vertex.x);
+		box.maxY = std::max(box.maxY, vertex.y);
+	}
+
+	// Checks every vertex is a different corner of the bounds (so the hitbox is an axis aligned rectangle)
+	int corners = 0;
+
+	for (const Vec2& vertex : vertices)
+	{
+		bool onX = vertex.x == box.minX || vertex.x == box.maxX;
+		bool onY = vertex.y == box.minY || vertex.y == box.maxY;
+
+		if (!onX || !onY)
+			return false;
+
+		corners = corners | (1 << ((vertex.x == box.maxX ? 1 : 0) + (vertex.y == box.maxY ? 2 : 0)));
+	}
+
+	if (corners != 0b1111 || box.maxX - box.minX <= b2_linearSlop || box.maxY - box.minY <= b2_linearSlop)
+		return false;
+
+	// Moves the box into world space
+	box.minX = box.minX + def.position.x;
+	box.maxX = box.maxX + def.position.x;
+	box.minY = box.minY + def.position.y;
+	box.maxY = box.maxY + def.position.y;
+
+	return true;
+}
+
+static size_t findRoot(std::vector<size_t>& parents, size_t index)
+{
+	// Finds the root while halving the path to it
+	while (parents[index] != index)
+	{
+		parents[index] = parents[parents[index]];
+		index = parents[index];
+	}
+
+	return index;
+}
+
+/*
+* @brief Sorts and removes coordinates closer together than the tolerance
+*/
+static void snapCoordinates(std::vector<float>& values, float tolerance)
+{
+	std::sort(values.begin(), values.end());
+
+	std::vector<float> snapped;
+
+	for (float value : values)
+	{
+		if (snapped.empty() || value - snapped.back() > tolerance)
+			snapped.push_back(value);
+	}
+
+	values = std::move(snapped);
+}
+
+/*
+* @brief Gets the index of the snapped coordinate a value belongs to
+*/
+static size_t findCoordinate(const std::vector<float>& values, float value, float tolerance)
+{
+	return (size_t)(std::lower_bound(values.begin(), values.end(), value - tolerance) - values.begin());
+}
+
+/*
+* @brief Traces the outline of a group of touching boxes
+* 
+* The boxes are rasterised onto a grid made from their own edges, then every edge between a filled and an
+* empty cell is followed (with the filled cell always on its left) to make counter-clockwise outer loops and
+* clockwise hole loops
+* 
+* @return False if the group spans too many cells to trace
+*/
+static bool traceOutline(const std::vector<MergeBox>& boxes, std::vector<std::vector<Vec2>>& loops)
+{
+	const float tolerance = b2_linearSlop;
+
+	// Makes the grid lines from the edges of the boxes
+	std::vector<float> xs, ys;
+
+	for (const MergeBox& box : boxes)
+	{
+		xs.push_back(box.minX);
+		xs.push_back(box.maxX);
+		ys.push_back(box.minY);
+		ys.push_back(box.maxY);
+	}
+
+	snapCoordinates(xs, tolerance);
+	snapCoordinates(ys, tolerance);
+
+	size_t columns = xs.size() - 1;
+	size_t rows = ys.size() - 1;
+
+	if (columns * rows > MAX_MERGE_CELLS)
+		return false;
+
+	// Fills the cells covered by each box
+	std::vector<bool> filled(columns * rows, false);
+
+	for (const MergeBox& box : boxes)
+	{
+		size_t x0 = findCoordinate(xs, box.minX, tolerance), x1 = findCoordinate(xs, box.maxX, tolerance);
+		size_t y0 = findCoordinate(ys, box.minY, tolerance), y1 = findCoordinate(ys, box.maxY, tolerance);
+
+		for (size_t y = y0; y < y1; y++)
+		{
+			for (size_t x = x0; x < x1; x++)
+				filled[y * columns + x] = true;
+		}
+	}
+
+	auto isFilled = [&](long x, long y)
+	{
+		return x >= 0 && y >= 0 && x < (long)columns && y < (long)rows && filled[(size_t)y * columns + (size_t)x];
+	};
+
+	// Grid points are numbered y * xs.size() + x
+	auto pointId = [&](long x, long y) { return (size_t)y * xs.size() + (size_t)x; };
+
+	// Edges leaving each grid point (at most 2 where two filled cells only touch at a corner)
+	std::unordered_map<size_t, std::vector<size_t>> outgoing;
+	size_t edgeCount = 0;
+
+	auto addEdge = [&](size_t from, size_t to)
+	{
+		outgoing[from].push_back(to);
+		edgeCount++;
+	};
+
+	// Horizontal edges (the filled cell is on the left, so +x when the cell above in +y is filled)
+	for (long y = 0; y <= (long)rows; y++)
+	{
+		for (long x = 0; x < (long)columns; x++)
+		{
+			bool positive = isFilled(x, y);
+			bool negative = isFilled(x, y - 1);
+
+			if (positive && !negative)
+				addEdge(pointId(x, y), pointId(x + 1, y));
+
+			else if (negative && !positive)
+				addEdge(pointId(x + 1, y), pointId(x, y));
+		}
+	}
+
+	// Vertical edges (-y when the cell in +x is filled)
+	for (long x = 0; x <= (long)columns; x++)
+	{
+		for (long y = 0; y < (long)rows; y++)
+		{
+			bool positive = isFilled(x, y);
+			bool negative = isFilled(x - 1, y);
+
+			if (positive && !negative)
+				addEdge(pointId(x, y + 1), pointId(x, y));
+
+			else if (negative && !positive)
+				addEdge(pointId(x, y), pointId(x, y + 1));
+		}
+	}
+
+	auto getX = [&](size_t id) { return (long)(id % xs.size()); };
+	auto getY = [&](size_t id) { return (long)(id / xs.size()); };
+
+	// Follows the edges into loops
+	while (edgeCount > 0)
+	{
+		// Starts at any point with an edge left
+		auto start = std::find_if(outgoing.begin(), outgoing.end(), [](const auto& item) { return !item.second.empty(); });
+
+		size_t startId = start->first;
+		size_t current = startId;
+		long directionX = 0, directionY = 0;
+
+		std::vector<size_t> points;
+
+		do
+		{
+			std::vector<size_t>& next = outgoing[current];
+
+			// Prefers turning left, then going straight, then turning right so loops split where cells only touch at a corner
+			size_t chosen = 0;
+			int bestScore = -1;
+
+			for (size_t i = 0; i < next.size(); i++)
+			{
+				long dx = getX(next[i]) - getX(current);
+				long dy = getY(next[i]) - getY(current);
+				dx = (dx > 0) - (dx < 0);
+				dy = (dy > 0) - (dy < 0);
+
+				int score = 1;
+
+				if (dx == -directionY && dy == directionX)
+					score = 3;
+
+				else if (dx == directionX && dy == directionY)
+					score = 2;
+
+				if (score > bestScore)
+				{
+					bestScore = score;
+					chosen = i;
+				}
+			}
+
+			size_t target = next[chosen];
+			next.erase(next.begin() + chosen);
+			edgeCount--;
+
+			long dx = getX(target) - getX(current);
+			long dy = getY(target) - getY(current);
+			dx = (dx > 0) - (dx < 0);
+			dy = (dy > 0) - (dy < 0);
+
+			// Only keeps the points where the outline turns
+			if (points.empty() || dx != directionX || dy != directionY)
+				points.push_back(current);
+
+			directionX = dx;
+			directionY = dy;
+			current = target;
+		}
+		while (current != startId);
+
+		// Removes the start point if the outline goes straight through it
+		if (points.size() > 2)
+		{
+			long inX = getX(points[0]) - getX(points.back()), inY = getY(points[0]) - getY(points.back());
+			long outX = getX(points[1]) - getX(points[0]), outY = getY(points[1]) - getY(points[0]);
+
+			if (inX * outY - inY * outX == 0)
+				points.erase(points.begin());
+		}
+
+		// Converts the points to world space
+		std::vector<Vec2> loop;
+		loop.reserve(points.size());
+
+		for (size_t id : points)
+			loop.push_back(Vec2(xs[getX(id)], ys[getY(id)]));
+
+		if (loop.size() >= 3)
+			loops.push_back(std::move(loop));
+	}
+
+	return true;
+}
+
+std::vector<StaticBoxGroup> findStaticBoxGroups(const LevelDef& levelDef)
+{
+	const float tolerance = b2_linearSlop;
+
+	// Finds every static box
+	std::vector<MergeBox> boxes;
+
+	for (size_t i = 0; i < levelDef.physicalEntities.size(); i++)
+	{
+		MergeBox box;
+
+		if (getStaticBox(levelDef.physicalEntities[i], i, box))
+			boxes.push_back(box);
+	}
+
+	// Groups boxes that touch or overlap by sweeping from left to right
+	std::sort(boxes.begin(), boxes.end(), [](const MergeBox& a, const MergeBox& b) { return a.minX < b.minX; });
+
+	std::vector<size_t> parents(boxes.size());
+
+	for (size_t i = 0; i < boxes.size(); i++)
+		parents[i] = i;
+
+	std::vector<size_t> active;
+
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		// Drops the boxes that end before this one starts
+		active.erase(std::remove_if(active.begin(), active.end(), [&](size_t j) { return boxes[j].maxX + tolerance < boxes[i].minX; }), active.end());
+
+		for (size_t j : active)
+		{
+			if (boxes[j].minY <= boxes[i].maxY + tolerance && boxes[i].minY <= boxes[j].maxY + tolerance)
+				parents[findRoot(parents, i)] = findRoot(parents, j);
+		}
+
+		active.push_back(i);
+	}
+
+	// Collects the boxes of each group
+	std::unordered_map<size_t, std::vector<MergeBox>> groupBoxes;
+
+	for (size_t i = 0; i < boxes.size(); i++)
+		groupBoxes[findRoot(parents, i)].push_back(boxes[i]);
+
+	// Traces the outline of every group with more than one box
+	std::vector<StaticBoxGroup> groups;
+
+	for (auto& item : groupBoxes)
+	{
+		if (item.second.size() < 2)
+			continue;
+
+		StaticBoxGroup group;
+
+		if (!traceOutline(item.second, group.loops))
+			continue;
+
+		for (const MergeBox& box : item.second)
+			group.defIndices.push_back(box.defIndex);
+
+		std::sort(group.defIndices.begin(), group.defIndices.end());
+		groups.push_back(std::move(group));
+	}
+
+	// Keeps the order stable between runs
+	std::sort(groups.begin(), groups.end(), [](const StaticBoxGroup& a, const StaticBoxGroup& b) { return a.defIndices[0] < b.defIndices[0]; });
+
+	return groups;
+}
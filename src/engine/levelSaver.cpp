@@ -0,0 +1,166 @@
+#include <engine/levelSaver.h>
+
+#include <engine/entity.h>
+
+LevelSaver::~LevelSaver()
+{
+	// Writes anything that has not been written (errors cannot be thrown out of a destructor so every one is printed)
+	while (writing.valid())
+	{
+		try
+		{
+			wait();
+		}
+
+		catch (const std::exception& error)
+		{
+			std::cout << error.what() << std::endl;
+		}
+	}
+}
+
+template<typename ENTITY>
+std::shared_ptr<const std::string> LevelSaver::getFragment(ENTITY* entity)
+{
+	auto found = fragments.find(entity->getId());
+
+	// Converts the entity if it is new or has changed since it was last saved
+	if (found == fragments.end() || found->second.revision != entity->getRevision())
+	{
+		Fragment fragment;
+		fragment.revision = entity->getRevision();
+		fragment.json = std::make_shared<const std::string>(entityToJson(createDefOf(entity)));
+
+		found = fragments.insert_or_assign(entity->getId(), fragment).first;
+		lastConverted++;
+	}
+
+	found->second.lastUsed = saveCount;
+	return found->second.json;
+}
+
+void LevelSaver::save(const Level& level, const std::string& levelPath)
+{
+	saveCount++;
+	lastConverted = 0;
+
+	// Takes the JSON of every entity now, as the entities can change while the file is being written
+	std::unique_ptr<SaveJob> job = std::make_unique<SaveJob>();
+	job->path = levelPath;
+	job->graphicEntities.reserve(level.graphicEntities.size());
+	job->physicalEntities.reserve(level.physicalEntities.size());
+
+	for (GraphicEntity* entity : level.graphicEntities)
+		job->graphicEntities.push_back(getFragment(entity));
+
+	for (PhysicalEntity* entity : level.physicalEntities)
+		job->physicalEntities.push_back(getFragment(entity));
+
+	// Drops the fragments of entities that are no longer in the level
+	for (auto it = fragments.begin(); it != fragments.end();)
+		it = (it->second.lastUsed != saveCount) ? fragments.erase(it) : std::next(it);
+
+	// Waits for the current write to finish before starting another one
+	if (writing.valid())
+		queued = std::move(job);
+
+	else
+		startWriting(std::move(job));
+}
+
+void LevelSaver::update()
+{
+	// Does nothing while a write is still going
+	if (!writing.valid() || writing.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return;
+
+	finishWriting();
+}
+
+void LevelSaver::wait()
+{
+	while (writing.valid())
+		finishWriting();
+}
+
+void LevelSaver::finishWriting()
+{
+	std::exception_ptr error;
+
+	// get rethrows any error from the background thread, which is held until the queued save has been started
+	try
+	{
+		writing.get();
+	}
+
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	// A failed write never drops the newer save waiting behind it
+	if (queued != nullptr)
+		startWriting(std::move(queued));
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void LevelSaver::startWriting(std::unique_ptr<SaveJob> job)
+{
+	// The thread owns the job so it stays alive until it has been written
+	writing = std::async(std::launch::async, [job = std::shared_ptr<SaveJob>(std::move(job))]() { write(*job); });
+}
+
+void LevelSaver::write(const SaveJob& job)
+{
+	// Joins a list of fragments into a JSON array
+	auto writeArray = [](std::ofstream& file, const std::vector<std::shared_ptr<const std::string>>& fragments)
+	{
+		file << '[';
+
+		for (size_t i = 0; i < fragments.size(); i++)
+		{
+			if (i != 0)
+				file << ',';
+
+			file << *fragments[i];
+		}
+
+		file << ']';
+	};
+
+	// Writes to a temporary file first
+	std::string tempPath = job.path + ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		throw std::runtime_error("Error: could not open file " + tempPath);
+
+	// Writes the same layout as saveToJson (keys in order, empty arrays left out)
+	file << '{';
+
+	if (!job.graphicEntities.empty())
+	{
+		file << "\"graphicEntities\":";
+		writeArray(file, job.graphicEntities);
+	}
+
+	if (!job.physicalEntities.empty())
+	{
+		if (!job.graphicEntities.empty())
+			file << ',';
+
+		file << "\"physicalEntities\":";
+		writeArray(file, job.physicalEntities);
+	}
+
+	file << '}';
+	file.close();
+
+	if (!file.good())
+		throw std::runtime_error("Error: could not write file " + tempPath);
+
+	// Replaces the level file in one step so it is never left half written
+	std::filesystem::rename(tempPath, job.path);
+}
@@ -0,0 +1,407 @@
+#include <engine/level.h>
+
+#include <engine/entity.h>
+
+/*
+* @brief SAX handler that builds one entity def at a time as the tokens of a level file arrive
+*/
+class LevelSaxHandler : public nl::json_sax<nl::json>
+{
+	private:
+		/*
+		* @brief What the parser is currently inside of
+		*/
+		enum class Context
+		{
+			ROOT,
+			ENTITY_ARRAY,
+			ENTITY,
+			VEC2,
+			HITBOX_ARRAY,
+			HITBOX
+		};
+
+		// Stack of what the parser is inside of
+		std::vector<Context> stack;
+
+		// Depth of an unknown value that is being skipped (0 when not skipping)
+		size_t skipDepth = 0;
+
+		// Last key that was read
+		std::string currentKey;
+
+		// Whether the entity array being read is physicalEntities
+		bool readingPhysical = false;
+
+		// Def being built (only one entity is in memory at a time)
+		GraphicDef graphicDef;
+		PhysicalDef physicalDef;
+
+		// Which values have been read for the current entity
+		bool hasSize = false;
+		bool hasPosition = false;
+		bool hasBodyType = false;
+
+		// Vector being read and which of its values have been read
+		Vec2* currentVec = nullptr;
+		std::string currentVecName;
+		bool hasX = false;
+		bool hasY = false;
+
+		// Functions called with each finished def
+		const std::function<void(const GraphicDef&)>& onGraphic;
+		const std::function<void(const PhysicalDef&)>& onPhysical;
+
+		/*
+		* @brief Gets the GraphicDef part of the entity being read
+		*/
+		GraphicDef& currentDef()
+		{
+			return readingPhysical ? static_cast<GraphicDef&>(physicalDef) : graphicDef;
+		}
+
+		/*
+		* @brief Starts reading a vector
+		*/
+		void beginVec(Vec2* target, const std::string& name)
+		{
+			stack.push_back(Context::VEC2);
+
+			currentVec = target;
+			currentVecName = name;
+			hasX = false;
+			hasY = false;
+		}
+
+		/*
+		* @brief Called for every value that is not an object or an array
+		*
+		* @param isNumber Whether the value is a number
+		* @param number Value of the number
+		* @param text Value of the string (nullptr if the value is not a string)
+		*/
+		bool scalar(bool isNumber, double number, const std::string* text)
+		{
+			// Ignores values inside of unknown values
+			if (skipDepth != 0)
+				return true;
+
+			switch (stack.empty() ? Context::ROOT : stack.back())
+			{
+				case Context::ROOT:
+					if (currentKey == "graphicEntities" || currentKey == "physicalEntities")
+						throw std::runtime_error("Error: " + currentKey + " is not an array in JSON file");
+
+					return true;
+
+				case Context::ENTITY_ARRAY:
+					throw std::runtime_error("Error: entity is not an object in JSON file");
+
+				case Context::ENTITY:
+					if (currentKey == "size" || currentKey == "position")
+						throw std::runtime_error("Error: " + currentKey + " is not a vector in JSON file");
+
+					if (currentKey == "texture")
+					{
+						if (text == nullptr)
+							throw std::runtime_error("Error: texture is not a string in JSON file");
+
+						currentDef().texture = *text;
+					}
+
+					else if (currentKey == "layer" || currentKey == "depth")
+					{
+						if (!isNumber)
+							throw std::runtime_error("Error: " + currentKey + " is not a number in JSON file");
+
+						if (currentKey == "layer")
+							currentDef().layer = (int)number;
+
+						else
+							currentDef().depth = (float)number;
+					}
+
+					else if (readingPhysical && currentKey == "hitboxes")
+						throw std::runtime_error("Error: hitboxes is not an array in JSON file");
+
+					else if (readingPhysical && currentKey == "bodyType")
+					{
+						if (text == nullptr)
+							throw std::runtime_error("Error: bodyType is not a string in JSON file");
+
+						physicalDef.bodyType = convertFromStr(*text);
+						hasBodyType = true;
+					}
+
+					return true;
+
+				case Context::VEC2:
+					if (currentKey == "x" || currentKey == "y")
+					{
+						if (!isNumber)
+							throw std::runtime_error("Error: " + currentVecName + " has a value that is not a number in JSON file");
+
+						if (currentKey == "x")
+						{
+							currentVec->x = (float)number;
+							hasX = true;
+						}
+
+						else
+						{
+							currentVec->y = (float)number;
+							hasY = true;
+						}
+					}
+
+					return true;
+
+				case Context::HITBOX_ARRAY:
+					throw std::runtime_error("Error: hitbox is not an array in JSON file");
+
+				case Context::HITBOX:
+					throw std::runtime_error("Error: vertex is not an object in JSON file");
+			}
+
+			return true;
+		}
+
+		/*
+		* @brief Checks the entity that was just read and hands it to the callback
+		*/
+		void finishEntity()
+		{
+			if (!hasSize || !hasPosition)
+				throw std::runtime_error("Error: entity is missing size or position in JSON file");
+
+			if (readingPhysical)
+			{
+				if (!hasBodyType)
+					throw std::runtime_error("Error: physical entity is missing bodyType in JSON file");
+
+				onPhysical(physicalDef);
+			}
+
+			else
+				onGraphic(graphicDef);
+		}
+
+	public:
+		LevelSaxHandler(const std::function<void(const GraphicDef&)>& onGraphic, const std::function<void(const PhysicalDef&)>& onPhysical)
+			: onGraphic(onGraphic), onPhysical(onPhysical) {}
+
+		bool null() override { return scalar(false, 0.0, nullptr); }
+		bool boolean(bool) override { return scalar(false, 0.0, nullptr); }
+		bool number_integer(number_integer_t value) override { return scalar(true, (double)value, nullptr); }
+		bool number_unsigned(number_unsigned_t value) override { return scalar(true, (double)value, nullptr); }
+		bool number_float(number_float_t value, const string_t&) override { return scalar(true, (double)value, nullptr); }
+		bool string(string_t& value) override { return scalar(false, 0.0, &value); }
+		bool binary(binary_t&) override { return scalar(false, 0.0, nullptr); }
+
+		bool key(string_t& value) override
+		{
+			// Keys inside of skipped values do not matter
+			if (skipDepth == 0)
+				currentKey = value;
+
+			return true;
+		}
+
+		bool start_object(std::size_t) override
+		{
+			// Keeps track of how deep into a skipped value the parser is
+			if (skipDepth != 0)
+			{
+				skipDepth++;
+				return true;
+			}
+
+			// The root object
+			if (stack.empty())
+			{
+				stack.push_back(Context::ROOT);
+				return true;
+			}
+
+			switch (stack.back())
+			{
+				case Context::ROOT:
+					if (currentKey == "graphicEntities" || currentKey == "physicalEntities")
+						throw std::runtime_error("Error: " + currentKey + " is not an array in JSON file");
+
+					skipDepth = 1;
+					return true;
+
+				case Context::ENTITY_ARRAY:
+					// Starts a new entity (reusing the memory of the last one)
+					stack.push_back(Context::ENTITY);
+
+					graphicDef = GraphicDef();
+					physicalDef.texture.clear();
+					physicalDef.layer = 0;
+					physicalDef.depth = 0.0f;
+					physicalDef.bodyType = b2_staticBody;
+					physicalDef.fixtureVertices.clear();
+
+					hasSize = false;
+					hasPosition = false;
+					hasBodyType = false;
+					return true;
+
+				case Context::ENTITY:
+					if (currentKey == "size")
+						beginVec(&currentDef().size, "size");
+
+					else if (currentKey == "position")
+						beginVec(&currentDef().position, "position");
+
+					else if (readingPhysical && currentKey == "hitboxes")
+						throw std::runtime_error("Error: hitboxes is not an array in JSON file");
+
+					else
+						skipDepth = 1;
+
+					return true;
+
+				case Context::HITBOX_ARRAY:
+					throw std::runtime_error("Error: hitbox is not an array in JSON file");
+
+				case Context::HITBOX:
+					// Starts a new vertex of the hitbox
+					physicalDef.fixtureVertices.back().push_back(Vec2());
+					beginVec(&physicalDef.fixtureVertices.back().back(), "vertex");
+					return true;
+
+				case Context::VEC2:
+					skipDepth = 1;
+					return true;
+			}
+
+			return true;
+		}
+
+		bool end_object() override
+		{
+			// Leaves a skipped value
+			if (skipDepth != 0)
+			{
+				skipDepth--;
+				return true;
+			}
+
+			Context context = stack.back();
+			stack.pop_back();
+
+			if (context == Context::VEC2)
+			{
+				if (!hasX || !hasY)
+					throw std::runtime_error("Error: " + currentVecName + " is missing x or y in JSON file");
+
+				// Marks which value of the entity was read
+				if (currentVecName == "size")
+					hasSize = true;
+
+				else if (currentVecName == "position")
+					hasPosition = true;
+			}
+
+			else if (context == Context::ENTITY)
+				finishEntity();
+
+			return true;
+		}
+
+		bool start_array(std::size_t) override
+		{
+			// Keeps track of how deep into a skipped value the parser is
+			if (skipDepth != 0)
+			{
+				skipDepth++;
+				return true;
+			}
+
+			// Levels must be an object, anything else is treated as an empty level
+			if (stack.empty())
+			{
+				skipDepth = 1;
+				return true;
+			}
+
+			switch (stack.back())
+			{
+				case Context::ROOT:
+					if (currentKey == "graphicEntities" || currentKey == "physicalEntities")
+					{
+						readingPhysical = currentKey == "physicalEntities";
+						stack.push_back(Context::ENTITY_ARRAY);
+					}
+
+					else
+						skipDepth = 1;
+
+					return true;
+
+				case Context::ENTITY_ARRAY:
+					throw std::runtime_error("Error: entity is not an object in JSON file");
+
+				case Context::ENTITY:
+					if (currentKey == "size" || currentKey == "position")
+						throw std::runtime_error("Error: " + currentKey + " is not a vector in JSON file");
+
+					if (readingPhysical && currentKey == "hitboxes")
+						stack.push_back(Context::HITBOX_ARRAY);
+
+					else
+						skipDepth = 1;
+
+					return true;
+
+				case Context::HITBOX_ARRAY:
+					// Starts a new hitbox
+					stack.push_back(Context::HITBOX);
+					physicalDef.fixtureVertices.emplace_back();
+					return true;
+
+				case Context::HITBOX:
+					throw std::runtime_error("Error: vertex is not an object in JSON file");
+
+				case Context::VEC2:
+					skipDepth = 1;
+					return true;
+			}
+
+			return true;
+		}
+
+		bool end_array() override
+		{
+			// Leaves a skipped value
+			if (skipDepth != 0)
+			{
+				skipDepth--;
+				return true;
+			}
+
+			stack.pop_back();
+			return true;
+		}
+
+		bool parse_error(std::size_t, const std::string&, const nl::detail::exception& error) override
+		{
+			throw std::runtime_error(std::string("Error: could not parse JSON file: ") + error.what());
+		}
+};
+
+void streamLevelDef(const std::string& levelPath, const std::function<void(const GraphicDef&)>& onGraphic, const std::function<void(const PhysicalDef&)>& onPhysical)
+{
+	// Opens the file
+	std::ifstream file(levelPath, std::ios::binary);
+
+	// Checks if the file is open
+	if (!file.is_open())
+		throw std::runtime_error("Error: could not open file " + levelPath);
+
+	// Parses the file token by token
+	LevelSaxHandler handler(onGraphic, onPhysical);
+	nl::json::sax_parse(file, &handler);
+}
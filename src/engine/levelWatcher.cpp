@@ -0,0 +1,228 @@
+#include <engine/levelWatcher.h>
+
+#include <engine/entity.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#ifndef __linux__
+// How often the modification time of the file is checked (milliseconds)
+constexpr int LEVEL_WATCH_POLL_INTERVAL_MS = 250;
+#endif
+
+/*
+* @brief Gets the key two defs must share to be the same entity
+*/
+template<typename DEF>
+static std::string getExactKey(const DEF& def)
+{
+	return entityToJson(def);
+}
+
+/*
+* @brief Gets the key two defs must share to be the same entity in a different position
+*/
+template<typename DEF>
+static std::string getMovedKey(DEF def)
+{
+	def.position = Vec2();
+	return entityToJson(def);
+}
+
+/*
+* @brief Matches the entities made from the old defs with the new defs, reusing as many as possible
+* 
+* @param entities Entities made from the old defs (replaced with entities for the new defs, in the same order)
+* @param oldDefs Defs the entities were made from
+* @param newDefs Defs that were just read
+* @param stats Counts of each change made
+*/
+template<typename ENTITY, typename DEF>
+static void applyDifference(std::vector<ENTITY*>& entities, const std::vector<DEF>& oldDefs, const std::vector<DEF>& newDefs, LevelReloadStats& stats)
+{
+	std::vector<ENTITY*> result(newDefs.size(), nullptr);
+	std::vector<bool> used(entities.size(), false);
+
+	// Matches new defs with old defs that have the same key (old entities are taken in order so duplicates keep their order)
+	auto match = [&](auto getKey, const std::function<void(ENTITY*, const DEF&)>& reuse)
+	{
+		std::unordered_map<std::string, std::vector<size_t>> unusedByKey;
+
+		for (size_t i = entities.size(); i > 0; i--)
+		{
+			if (!used[i - 1])
+				unusedByKey[getKey(oldDefs[i - 1])].push_back(i - 1);
+		}
+
+		for (size_t i = 0; i < newDefs.size(); i++)
+		{
+			if (result[i] != nullptr)
+				continue;
+
+			auto found = unusedByKey.find(getKey(newDefs[i]));
+
+			if (found == unusedByKey.end() || found->second.empty())
+				continue;
+
+			size_t oldIndex = found->second.back();
+			found->second.pop_back();
+
+			used[oldIndex] = true;
+			result[i] = entities[oldIndex];
+			reuse(result[i], newDefs[i]);
+		}
+	};
+
+	// Keeps entities that have not changed at all
+	match(getExactKey<DEF>, [&](ENTITY*, const DEF&) { stats.kept++; });
+
+	// Teleports entities that only moved
+	match(getMovedKey<DEF>, [&](ENTITY* entity, const DEF& def) { entity->teleport(def.position); stats.moved++; });
+
+	// Removes the entities that were not matched (in one pass over Entity::instances)
+	std::unordered_set<Entity*> removed;
+
+	for (size_t i = 0; i < entities.size(); i++)
+	{
+		if (!used[i])
+			removed.insert(entities[i]);
+	}
+
+	Entity::remove(removed);
+	stats.removed += removed.size();
+
+	// Creates the entities that are new (or changed in a way that needs them to be recreated)
+	for (size_t i = 0; i < newDefs.size(); i++)
+	{
+		if (result[i] == nullptr)
+		{
+			result[i] = ENTITY::create(newDefs[i]);
+			stats.created++;
+		}
+	}
+
+	entities = std::move(result);
+}
+
+// --------------- LevelWatcher Member Functions --------------- //
+
+LevelWatcher::LevelWatcher(const std::string& levelPath) : levelPath(levelPath)
+{
+	// Starts watching before reading so changes made while loading are not missed
+	#ifdef __linux__
+	inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (inotifyDescriptor == -1)
+		throw std::runtime_error("Error: could not start watching " + levelPath);
+
+	std::filesystem::path directory = std::filesystem::path(levelPath).parent_path();
+	watchDescriptor = inotify_add_watch(inotifyDescriptor, directory.empty() ? "." : directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+	if (watchDescriptor == -1)
+	{
+		close(inotifyDescriptor);
+		throw std::runtime_error("Error: could not start watching " + levelPath);
+	}
+	#else
+	lastWriteTime = std::filesystem::last_write_time(levelPath);
+	lastCheck = std::chrono::steady_clock::now();
+	#endif
+
+	// Loads the level
+	levelDef = loadLevelDef(levelPath);
+	level = loadLevel(levelDef);
+}
+
+LevelWatcher::~LevelWatcher()
+{
+	#ifdef __linux__
+	// Closing the inotify instance also removes the watch
+	if (inotifyDescriptor != -1)
+		close(inotifyDescriptor);
+	#endif
+}
+
+bool LevelWatcher::hasChanged()
+{
+	#ifdef __linux__
+	bool changed = false;
+	std::string fileName = std::filesystem::path(levelPath).filename().string();
+
+	// Reads every event that has happened in the directory
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+
+	while ((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0)
+	{
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+
+			// Only events for the level file matter
+			if (event->len != 0 && fileName == event->name)
+				changed = true;
+
+			offset = offset + (ssize_t)sizeof(inotify_event) + (ssize_t)event->len;
+		}
+	}
+
+	return changed;
+	#else
+	// Only checks every so often as it touches the disk
+	auto now = std::chrono::steady_clock::now();
+
+	if (now - lastCheck < std::chrono::milliseconds(LEVEL_WATCH_POLL_INTERVAL_MS))
+		return false;
+
+	lastCheck = now;
+
+	// The file can briefly not exist while an editor replaces it
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(levelPath, error);
+
+	if (error || writeTime == lastWriteTime)
+		return false;
+
+	lastWriteTime = writeTime;
+	return true;
+	#endif
+}
+
+bool LevelWatcher::reload()
+{
+	// Reads the new file (a half written file is ignored as another change will follow it)
+	LevelDef newDef;
+
+	try
+	{
+		newDef = loadLevelDef(levelPath);
+	}
+
+	catch (const std::exception& error)
+	{
+		std::cout << error.what() << std::endl;
+		return false;
+	}
+
+	// Applies only what changed
+	lastReload = LevelReloadStats();
+
+	applyDifference(level.graphicEntities, levelDef.graphicEntities, newDef.graphicEntities, lastReload);
+	applyDifference(level.physicalEntities, levelDef.physicalEntities, newDef.physicalEntities, lastReload);
+
+	levelDef = std::move(newDef);
+	reloadCount++;
+
+	return true;
+}
+
+bool LevelWatcher::update()
+{
+	if (!hasChanged())
+		return false;
+
+	return reload();
+}
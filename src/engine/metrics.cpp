@@ -0,0 +1,328 @@
+#include <engine/metrics.h>
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+// Most bytes held for the socket while the reader catches up (whole lines past this are dropped)
+static constexpr size_t MAX_SOCKET_BACKLOG = 256 * 1024;
+
+// --------------- MetricHistogram Member Functions --------------- //
+
+void MetricHistogram::add(double value)
+{
+	values[next] = value;
+	next = (next + 1) % values.size();
+	count = std::min(count + 1, values.size());
+}
+
+MetricSummary MetricHistogram::summarise() const
+{
+	MetricSummary summary;
+	summary.samples = count;
+
+	if (count == 0)
+		return summary;
+
+	// The ring only wraps once it is full so the values are always the first count entries
+	std::vector<double> sorted(values.begin(), values.begin() + count);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+
+	for (double value : sorted)
+		total = total + value;
+
+	// Nearest rank percentile
+	auto percentile = [&](double p) { return sorted[std::min(std::max((size_t)std::ceil(p * count), (size_t)1), count) - 1]; };
+
+	summary.mean = total / (double)count;
+	summary.p50 = percentile(0.50);
+	summary.p95 = percentile(0.95);
+	summary.p99 = percentile(0.99);
+	summary.max = sorted.back();
+
+	return summary;
+}
+
+// --------------- MetricsRegistry Member Functions --------------- //
+
+MetricsRegistry::~MetricsRegistry()
+{
+	closeOutput();
+}
+
+size_t MetricsRegistry::getIndex(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto found = indices.find(name);
+
+	if (found != indices.end())
+		return found->second;
+
+	// Creates the metric the first time it is used
+	metrics.emplace_back();
+	metrics.back().name = name;
+
+	indices[name] = metrics.size() - 1;
+	return metrics.size() - 1;
+}
+
+void MetricsRegistry::set(size_t index, double value)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	metrics[index].value = value;
+	metrics[index].recorded = true;
+}
+
+void MetricsRegistry::add(size_t index, double amount)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	metrics[index].value = metrics[index].value + amount;
+	metrics[index].recorded = true;
+}
+
+void MetricsRegistry::endFrame()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Moves the values of this frame into the histograms
+	for (Metric& metric : metrics)
+	{
+		if (!metric.recorded)
+			continue;
+
+		metric.history.add(metric.value);
+		metric.last = metric.value;
+
+		metric.value = 0.0;
+		metric.recorded = false;
+	}
+
+	frame++;
+
+	// Writes a line every writeInterval frames if there is anywhere to write it
+	if (frame % writeInterval == 0 && (file.is_open() || !socketPath.empty()))
+		writeLine(buildLine().dump());
+}
+
+MetricSummary MetricsRegistry::getSummary(const std::string& name) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto found = indices.find(name);
+
+	if (found == indices.end())
+		return MetricSummary();
+
+	const Metric& metric = metrics[found->second];
+
+	MetricSummary summary = metric.history.summarise();
+	summary.last = metric.last;
+
+	return summary;
+}
+
+std::string MetricsRegistry::toJson() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return buildLine().dump();
+}
+
+nl::json MetricsRegistry::buildLine() const
+{
+	nl::json line;
+
+	// Wall clock time so lines from long runs can be matched with other logs
+	line["time"] = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	line["frame"] = frame;
+
+	nl::json& values = line["metrics"];
+	values = nl::json::object();
+
+	for (const Metric& metric : metrics)
+	{
+		MetricSummary summary = metric.history.summarise();
+
+		values[metric.name] = {
+			{ "last", metric.last },
+			{ "mean", summary.mean },
+			{ "p50", summary.p50 },
+			{ "p95", summary.p95 },
+			{ "p99", summary.p99 },
+			{ "max", summary.max }
+		};
+	}
+
+	return line;
+}
+
+void MetricsRegistry::openFile(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (file.is_open())
+		file.close();
+
+	file.open(path, std::ios::app);
+
+	if (!file.is_open())
+		throw std::runtime_error("Error: could not open metrics file " + path);
+}
+
+void MetricsRegistry::openSocket(const std::string& path)
+{
+#ifdef _WIN32
+	throw std::runtime_error("Error: metrics sockets are not supported on Windows");
+#else
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Checks the path fits in a socket address
+	if (path.empty() || path.size() >= sizeof(sockaddr_un::sun_path))
+		throw std::runtime_error("Error: invalid metrics socket path " + path);
+
+	disconnectSocket();
+	socketPath = path;
+	socketBacklog.clear();
+
+	// Connects now if the reader is already listening (otherwise the next line written tries again)
+	connectSocket();
+#endif
+}
+
+void MetricsRegistry::closeOutput()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (file.is_open())
+		file.close();
+
+	disconnectSocket();
+	socketPath.clear();
+	socketBacklog.clear();
+}
+
+size_t MetricsRegistry::getDroppedLines() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return droppedLines;
+}
+
+void MetricsRegistry::writeLine(const std::string& line)
+{
+	if (file.is_open())
+		file << line << "\n" << std::flush;
+
+#ifndef _WIN32
+	if (socketPath.empty())
+		return;
+
+	// Reconnects if the reader went away (at most once a second so a missing reader costs nothing)
+	if (socketHandle == -1)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		if (now - lastConnectAttempt < std::chrono::seconds(1) || !connectSocket())
+		{
+			droppedLines++;
+			return;
+		}
+	}
+
+	// Queues the line unless the reader is too far behind
+	if (socketBacklog.size() + line.size() + 1 > MAX_SOCKET_BACKLOG)
+	{
+		droppedLines++;
+		return;
+	}
+
+	socketBacklog += line;
+	socketBacklog += '\n';
+
+	// Sends as much as the socket takes without blocking
+	int flags = MSG_DONTWAIT;
+
+#ifdef MSG_NOSIGNAL
+	flags = flags | MSG_NOSIGNAL;
+#endif
+
+	while (!socketBacklog.empty())
+	{
+		ssize_t sent = send(socketHandle, socketBacklog.data(), socketBacklog.size(), flags);
+
+		if (sent > 0)
+		{
+			socketBacklog.erase(0, (size_t)sent);
+			continue;
+		}
+
+		// Full, the rest is sent with the next line
+		if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+
+		if (sent < 0 && errno == EINTR)
+			continue;
+
+		// The reader has gone, a half sent line would corrupt the next reader so the backlog is dropped
+		disconnectSocket();
+		droppedLines++;
+		break;
+	}
+#endif
+}
+
+bool MetricsRegistry::connectSocket()
+{
+#ifdef _WIN32
+	return false;
+#else
+	lastConnectAttempt = std::chrono::steady_clock::now();
+
+	int handle = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (handle == -1)
+		return false;
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+	if (connect(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1)
+	{
+		close(handle);
+		return false;
+	}
+
+	// Writes never block the frame
+	fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+
+#ifdef SO_NOSIGPIPE
+	// Platforms without MSG_NOSIGNAL
+	int enabled = 1;
+	setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+
+	socketHandle = handle;
+	return true;
+#endif
+}
+
+void MetricsRegistry::disconnectSocket()
+{
+#ifndef _WIN32
+	if (socketHandle != -1)
+		close(socketHandle);
+#endif
+
+	socketHandle = -1;
+	socketBacklog.clear();
+}
@@ -0,0 +1,374 @@
+#include <engine/particles.h>
+
+#include <util/util.h>
+
+// Length of a step (the same as the b2World's)
+static constexpr float TIME_STEP = 1.0f / 60.0f;
+
+// Distance a bouncing particle is put in front of the surface it hit (meters)
+static constexpr float COLLISION_SKIN = 0.001f;
+
+/*
+* @brief Adds rates times a scale to values (four at a time with SSE2)
+*/
+static void addScaled(float* values, const float* rates, float scale, size_t count)
+{
+	size_t i = 0;
+
+#if VEC2_USE_SSE2
+	__m128 scales = _mm_set1_ps(scale);
+
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(values + i, _mm_add_ps(_mm_loadu_ps(values + i), _mm_mul_ps(_mm_loadu_ps(rates + i), scales)));
+#endif
+
+	// Whatever does not fill a register
+	for (; i < count; i++)
+		values[i] += rates[i] * scale;
+}
+
+/*
+* @brief Subtracts the same amount from every value (four at a time with SSE2)
+*/
+static void subtract(float* values, float amount, size_t count)
+{
+	size_t i = 0;
+
+#if VEC2_USE_SSE2
+	__m128 amounts = _mm_set1_ps(amount);
+
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(values + i, _mm_sub_ps(_mm_loadu_ps(values + i), amounts));
+#endif
+
+	for (; i < count; i++)
+		values[i] -= amount;
+}
+
+/*
+* @brief Converts a blended colour channel back to a byte
+*/
+static sf::Uint8 toChannel(float value)
+{
+	return (sf::Uint8)std::min(std::max(value, 0.0f), 255.0f);
+}
+
+/*
+* @brief Ray cast callback finding the closest static fixture along the ray
+*/
+class StaticRayCastCallback : public b2RayCastCallback
+{
+	public:
+		bool hit = false;
+		b2Vec2 point;
+		b2Vec2 normal;
+
+		float ReportFixture(b2Fixture* fixture, const b2Vec2& hitPoint, const b2Vec2& hitNormal, float fraction) override
+		{
+			// Particles pass through everything that moves
+			if (fixture->GetBody()->GetType() != b2_staticBody)
+				return -1.0f;
+
+			hit = true;
+			point = hitPoint;
+			normal = hitNormal;
+
+			// Clips the ray so the closest fixture is the last one reported
+			return fraction;
+		}
+};
+
+ParticleSystem::ParticleSystem()
+{
+	vertices.setPrimitiveType(sf::Triangles);
+}
+
+float ParticleSystem::random()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+
+	// Uses the top 24 bits so every value is exact as a float
+	return (float)(randomState >> 8) / 16777216.0f;
+}
+
+void ParticleSystem::reserve(size_t needed)
+{
+	size_t capacity = fields[0].size();
+
+	if (needed <= capacity)
+		return;
+
+	// Doubles the capacity so creating particles one at a time does not resize every time
+	size_t newCapacity = std::min(std::max({ needed, capacity * 2, (size_t)1024 }), MAX_PARTICLES);
+
+	for (ParticleArray& field : fields)
+		field.resize(newCapacity);
+}
+
+void ParticleSystem::spawn(const ParticleEmitterDef& def, size_t amount)
+{
+	amount = std::min(amount, MAX_PARTICLES - count);
+
+	if (amount == 0)
+		return;
+
+	reserve(count + amount);
+
+	// Direction and speed the spread and variance are applied to
+	float baseAngle = std::atan2(def.velocity.y, def.velocity.x);
+	float baseSpeed = def.velocity.length();
+
+	for (size_t i = count; i < count + amount; i++)
+	{
+		float angle = baseAngle + randomSigned() * def.spread * 0.5f;
+		float speed = baseSpeed * (1.0f + randomSigned() * def.speedVariance);
+
+		// Never lets a particle start dead (the colour rates divide by its life)
+		float life = std::max(def.lifetime + randomSigned() * def.lifetimeVariance, TIME_STEP);
+
+		fields[POSITION_X][i] = def.position.x + randomSigned() * def.area.x;
+		fields[POSITION_Y][i] = def.position.y + randomSigned() * def.area.y;
+		fields[VELOCITY_X][i] = std::cos(angle) * speed;
+		fields[VELOCITY_Y][i] = std::sin(angle) * speed;
+		fields[GRAVITY][i] = def.gravity;
+		fields[LIFE][i] = life;
+		fields[SIZE][i] = def.size;
+
+		// Colour channels are blended as floats, changing by their rate every second
+		fields[RED][i] = def.startColor.r;
+		fields[GREEN][i] = def.startColor.g;
+		fields[BLUE][i] = def.startColor.b;
+		fields[ALPHA][i] = def.startColor.a;
+		fields[RED_RATE][i] = ((float)def.endColor.r - def.startColor.r) / life;
+		fields[GREEN_RATE][i] = ((float)def.endColor.g - def.startColor.g) / life;
+		fields[BLUE_RATE][i] = ((float)def.endColor.b - def.startColor.b) / life;
+		fields[ALPHA_RATE][i] = ((float)def.endColor.a - def.startColor.a) / life;
+
+		fields[RESTITUTION][i] = def.collide ? def.restitution : -1.0f;
+	}
+
+	count += amount;
+}
+
+void ParticleSystem::integrate(float dt)
+{
+	// Velocity first so the position moves with the new velocity (semi-implicit Euler, like Box2D)
+	addScaled(fields[VELOCITY_Y].data(), fields[GRAVITY].data(), dt, count);
+
+	addScaled(fields[POSITION_X].data(), fields[VELOCITY_X].data(), dt, count);
+	addScaled(fields[POSITION_Y].data(), fields[VELOCITY_Y].data(), dt, count);
+
+	addScaled(fields[RED].data(), fields[RED_RATE].data(), dt, count);
+	addScaled(fields[GREEN].data(), fields[GREEN_RATE].data(), dt, count);
+	addScaled(fields[BLUE].data(), fields[BLUE_RATE].data(), dt, count);
+	addScaled(fields[ALPHA].data(), fields[ALPHA_RATE].data(), dt, count);
+
+	subtract(fields[LIFE].data(), dt, count);
+}
+
+void ParticleSystem::collide(float dt)
+{
+	size_t interval = std::max(PARTICLE_COLLISION_INTERVAL, 1u);
+
+	// Each particle casts once every interval steps, so it looks as far ahead as it moves until its next cast
+	float lookAhead = dt * interval;
+
+	float* positionX = fields[POSITION_X].data();
+	float* positionY = fields[POSITION_Y].data();
+	float* velocityX = fields[VELOCITY_X].data();
+	float* velocityY = fields[VELOCITY_Y].data();
+	const float* restitution = fields[RESTITUTION].data();
+
+	// Only the particles whose turn it is (every interval-th particle starting at an offset that changes each step)
+	for (size_t i = step % interval; i < count; i += interval)
+	{
+		if (restitution[i] < 0.0f)
+			continue;
+
+		Vec2 start(positionX[i], positionY[i]);
+		Vec2 end = start + Vec2(velocityX[i], velocityY[i]) * lookAhead;
+
+		// Box2D cannot cast a ray with no length
+		if ((end - start).dot(end - start) < 1e-8f)
+			continue;
+
+		StaticRayCastCallback callback;
+		engineInstance->world->RayCast(&callback, start, end);
+
+		if (!callback.hit)
+			continue;
+
+		Vec2 normal = callback.normal;
+		Vec2 velocity(velocityX[i], velocityY[i]);
+		float normalSpeed = velocity.dot(normal);
+
+		// Already moving away from the surface
+		if (normalSpeed >= 0.0f)
+			continue;
+
+		// Puts the particle on the surface and reflects the part of its velocity going into it
+		Vec2 position = Vec2(callback.point) + normal * COLLISION_SKIN;
+		velocity = velocity - normal * (normalSpeed * (1.0f + restitution[i]));
+
+		positionX[i] = position.x;
+		positionY[i] = position.y;
+		velocityX[i] = velocity.x;
+		velocityY[i] = velocity.y;
+	}
+}
+
+void ParticleSystem::removeDead()
+{
+	size_t i = 0;
+
+	while (i < count)
+	{
+		if (fields[LIFE][i] > 0.0f)
+		{
+			i++;
+			continue;
+		}
+
+		// Moves the last particle into the dead one's place (checked again on the next pass of the loop)
+		count--;
+
+		for (ParticleArray& field : fields)
+			field[i] = field[count];
+	}
+}
+
+size_t ParticleSystem::addEmitter(const ParticleEmitterDef& def)
+{
+	Emitter emitter;
+	emitter.def = def;
+	emitter.active = true;
+
+	// Reuses the slot of a removed emitter
+	for (size_t id = 0; id < emitters.size(); id++)
+	{
+		if (!emitters[id].active)
+		{
+			emitters[id] = emitter;
+			return id;
+		}
+	}
+
+	emitters.push_back(emitter);
+
+	return emitters.size() - 1;
+}
+
+void ParticleSystem::removeEmitter(size_t id)
+{
+	// Checks the emitter exists
+	getEmitter(id);
+
+	emitters[id].active = false;
+}
+
+ParticleEmitterDef& ParticleSystem::getEmitter(size_t id)
+{
+	if (id >= emitters.size() || !emitters[id].active)
+		throw std::runtime_error("Error: particle emitter " + std::to_string(id) + " does not exist");
+
+	return emitters[id].def;
+}
+
+void ParticleSystem::emit(const ParticleEmitterDef& def, size_t amount)
+{
+	spawn(def, amount);
+}
+
+void ParticleSystem::clear()
+{
+	count = 0;
+}
+
+void ParticleSystem::update()
+{
+	step++;
+
+	// Creates the particles each emitter owes, carrying the fractions over
+	for (Emitter& emitter : emitters)
+	{
+		if (!emitter.active)
+			continue;
+
+		emitter.accumulator += emitter.def.rate * TIME_STEP;
+
+		size_t amount = (size_t)emitter.accumulator;
+		emitter.accumulator -= amount;
+
+		spawn(emitter.def, amount);
+	}
+
+	integrate(TIME_STEP);
+	collide(TIME_STEP);
+	removeDead();
+}
+
+void ParticleSystem::render()
+{
+	// Bounds of the view (meters)
+	Vec2 viewMin = (engineInstance->getViewCenter() - engineInstance->getViewSize() / 2.0f) / Engine::pxToMeter;
+	Vec2 viewMax = (engineInstance->getViewCenter() + engineInstance->getViewSize() / 2.0f) / Engine::pxToMeter;
+
+	// Keeps its memory when shrinking so the array is only allocated while the number of particles grows
+	vertices.resize(count * 6);
+
+	size_t drawn = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		float x = fields[POSITION_X][i];
+		float y = fields[POSITION_Y][i];
+		float half = fields[SIZE][i] / 2.0f;
+
+		// Skips the particles outside the view
+		if (x + half < viewMin.x || x - half > viewMax.x || y + half < viewMin.y || y - half > viewMax.y)
+			continue;
+
+		sf::Color color(toChannel(fields[RED][i]), toChannel(fields[GREEN][i]), toChannel(fields[BLUE][i]), toChannel(fields[ALPHA][i]));
+
+		sf::Vector2f topLeft(x - half, y - half);
+		sf::Vector2f topRight(x + half, y - half);
+		sf::Vector2f bottomLeft(x - half, y + half);
+		sf::Vector2f bottomRight(x + half, y + half);
+
+		// Two triangles per particle
+		sf::Vertex* quad = &vertices[drawn * 6];
+
+		quad[0] = sf::Vertex(topLeft, color);
+		quad[1] = sf::Vertex(topRight, color);
+		quad[2] = sf::Vertex(bottomLeft, color);
+		quad[3] = sf::Vertex(bottomLeft, color);
+		quad[4] = sf::Vertex(topRight, color);
+		quad[5] = sf::Vertex(bottomRight, color);
+
+		drawn++;
+	}
+
+	vertices.resize(drawn * 6);
+	drawnCount = drawn;
+
+	if (drawn == 0)
+		return;
+
+	// The vertices are in meters, like the entities' draw rects
+	sf::RenderStates states;
+	states.transform.scale(Engine::pxToMeter, Engine::pxToMeter);
+
+	engineInstance->getCommandBuffer().custom(vertices, states, layer);
+}
+
+SystemAccess ParticleSystem::getAccess() const
+{
+	SystemAccess access;
+	access.reads = RESOURCE_WORLD | RESOURCE_PARTICLES;
+	access.writes = RESOURCE_PARTICLES;
+	access.mainThread = false;
+
+	return access;
+}
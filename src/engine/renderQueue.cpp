@@ -0,0 +1,223 @@
+#include <engine/renderQueue.h>
+
+#include <util/util.h>
+
+#include <algorithm>
+#include <cstring>
+
+// Number of bits each part of the sort key uses
+#define LAYER_BITS 8
+#define STATE_BITS 12
+#define DEPTH_BITS 32
+
+static uint32_t sortableFloat(float value)
+{
+	// Reinterprets the float as an unsigned integer
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	// Flips all bits of negative numbers and just the sign bit of positive ones so integer order matches float order
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+uint64_t RenderQueue::makeKey(int layer, uint32_t shaderId, uint32_t textureId, float depth)
+{
+	// Moves the layer into an unsigned range so negative layers sort first
+	uint64_t layerBits = (uint64_t)(std::min(std::max(layer, MIN_LAYER), MAX_LAYER) - MIN_LAYER);
+
+	// Clamps the ids to the space they have in the key
+	uint64_t maxId = (1u << STATE_BITS) - 1;
+	uint64_t shaderBits = std::min((uint64_t)shaderId, maxId);
+	uint64_t textureBits = std::min((uint64_t)textureId, maxId);
+
+	return
+		(layerBits << (DEPTH_BITS + STATE_BITS * 2)) |
+		(shaderBits << (DEPTH_BITS + STATE_BITS)) |
+		(textureBits << DEPTH_BITS) |
+		(uint64_t)sortableFloat(depth);
+}
+
+uint32_t RenderQueue::getStateId(const void* state)
+{
+	// No shader or texture always has the lowest id
+	if (state == nullptr)
+		return 0;
+
+	// Gives the state the next id if it has not been seen this frame
+	auto found = stateIds.find(state);
+
+	if (found != stateIds.end())
+		return found->second;
+
+	uint32_t id = (uint32_t)stateIds.size() + 1;
+	stateIds[state] = id;
+
+	return id;
+}
+
+static bool sameStates(const sf::RenderStates& a, const sf::RenderStates& b)
+{
+	return a.texture == b.texture && a.shader == b.shader && a.blendMode == b.blendMode && a.transform == b.transform;
+}
+
+static bool overlaps(const sf::FloatRect& a, const sf::FloatRect& b)
+{
+	// Inclusive so lines with no width or height are not culled
+	return a.left <= b.left + b.width && a.left + a.width >= b.left && a.top <= b.top + b.height && a.top + a.height >= b.top;
+}
+
+static sf::FloatRect getBounds(const sf::Vertex* vertices, uint32_t count)
+{
+	sf::Vector2f min = vertices[0].position;
+	sf::Vector2f max = vertices[0].position;
+
+	for (uint32_t i = 1; i < count; i++)
+	{
+		min.x = std::min(min.x, vertices[i].position.x);
+		min.y = std::min(min.y, vertices[i].position.y);
+		max.x = std::max(max.x, vertices[i].position.x);
+		max.y = std::max(max.y, vertices[i].position.y);
+	}
+
+	return sf::FloatRect(min.x, min.y, max.x - min.x, max.y - min.y);
+}
+
+void RenderQueue::submit(CommandBuffer&& buffer)
+{
+	std::lock_guard<std::mutex> lock(submitMutex);
+	submittedBuffers.push_back(std::move(buffer));
+}
+
+void RenderQueue::drawBatch(sf::RenderTarget& target, sf::PrimitiveType type, const sf::RenderStates& states)
+{
+	// Draws every vertex in the batch with one draw call
+	target.draw(batchVertices.data(), batchVertices.size(), type, states);
+
+	drawCount++;
+	vertexCount = vertexCount + batchVertices.size();
+
+	if (states.shader != nullptr)
+		shaderDrawCount++;
+
+	batchVertices.clear();
+}
+
+void RenderQueue::flush(sf::RenderTarget& target)
+{
+	// Takes the buffers submitted from other threads
+	std::vector<CommandBuffer> buffers;
+
+	{
+		std::lock_guard<std::mutex> lock(submitMutex);
+		buffers.swap(submittedBuffers);
+	}
+
+	// Buffer 0 is the main buffer and the rest are the submitted ones
+	auto getBuffer = [&](uint32_t index) -> CommandBuffer& { return (index == 0) ? mainBuffer : buffers[index - 1]; };
+
+	// Builds the list of keys to sort
+	entries.clear();
+
+	for (uint32_t b = 0; b < buffers.size() + 1; b++)
+	{
+		CommandBuffer& buffer = getBuffer(b);
+
+		for (uint32_t c = 0; c < buffer.commands.size(); c++)
+		{
+			const RenderCommand& command = buffer.commands[c];
+			uint64_t key = makeKey(command.layer, getStateId(command.states.shader), getStateId(command.states.texture), command.depth);
+
+			entries.push_back({ key, b, c });
+		}
+	}
+
+	// Sorts the keys (stable so commands with equal keys keep the order they were recorded in)
+	radixSort64(entries, scratch, [](const SortEntry& entry) { return entry.key; });
+
+	// Gets the area of the world that is visible
+	const sf::View& view = target.getView();
+	sf::Vector2f viewSize = view.getSize();
+	sf::Vector2f viewCenter = view.getCenter();
+	sf::FloatRect viewRect(viewCenter.x - viewSize.x / 2, viewCenter.y - viewSize.y / 2, viewSize.x, viewSize.y);
+
+	drawCount = 0;
+	culledCount = 0;
+	vertexCount = 0;
+	shaderDrawCount = 0;
+
+	// State of the batch being built
+	sf::PrimitiveType batchType = sf::Triangles;
+	sf::RenderStates batchStates;
+
+	// Executes the commands in order
+	for (const SortEntry& entry : entries)
+	{
+		CommandBuffer& buffer = getBuffer(entry.buffer);
+		const RenderCommand& command = buffer.commands[entry.command];
+
+		// Quads and lines are culled and batched
+		if (command.type == RenderCommandType::QUAD || command.type == RenderCommandType::LINES)
+		{
+			const sf::Vertex* vertices = buffer.vertices.data() + command.first;
+
+			// Skips the command if it is outside of the view
+			if (command.count == 0 || !overlaps(command.states.transform.transformRect(getBounds(vertices, command.count)), viewRect))
+			{
+				culledCount++;
+				continue;
+			}
+
+			sf::PrimitiveType type = (command.type == RenderCommandType::QUAD) ? sf::Triangles : sf::Lines;
+
+			// Draws the current batch if this command can not be added to it
+			if (!batchVertices.empty() && (type != batchType || !sameStates(batchStates, command.states)))
+				drawBatch(target, batchType, batchStates);
+
+			batchType = type;
+			batchStates = command.states;
+
+			// Quads are turned from a triangle strip into two triangles so they can be joined together
+			if (command.type == RenderCommandType::QUAD)
+			{
+				batchVertices.push_back(vertices[0]);
+				batchVertices.push_back(vertices[1]);
+				batchVertices.push_back(vertices[2]);
+				batchVertices.push_back(vertices[1]);
+				batchVertices.push_back(vertices[3]);
+				batchVertices.push_back(vertices[2]);
+			}
+
+			else
+				batchVertices.insert(batchVertices.end(), vertices, vertices + command.count);
+
+			continue;
+		}
+
+		// Anything else has to be drawn on its own so the current batch is drawn first to keep the order
+		if (!batchVertices.empty())
+			drawBatch(target, batchType, batchStates);
+
+		if (command.type == RenderCommandType::TEXT)
+			target.draw(buffer.texts[command.first], command.states);
+
+		else
+			target.draw(*buffer.drawables[command.first], command.states);
+
+		drawCount++;
+
+		if (command.states.shader != nullptr)
+			shaderDrawCount++;
+	}
+
+	// Draws whatever is left in the batch
+	if (!batchVertices.empty())
+		drawBatch(target, batchType, batchStates);
+
+	// Empties the main buffer for the next frame (keeps the memory)
+	mainBuffer.clear();
+	stateIds.clear();
+}
+
+#undef LAYER_BITS
+#undef STATE_BITS
+#undef DEPTH_BITS
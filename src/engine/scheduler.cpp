@@ -0,0 +1,123 @@
+#include <engine/scheduler.h>
+
+#include <engine/base.h>
+
+#include <algorithm>
+
+void SystemScheduler::buildWaves()
+{
+	waves.clear();
+
+	std::vector<size_t> waveOf(systems.size());
+
+	for (size_t i = 0; i < systems.size(); i++)
+	{
+		// Goes after every earlier system it conflicts with
+		size_t wave = 0;
+
+		for (size_t j = 0; j < i; j++)
+		{
+			if (systems[i].access.conflictsWith(systems[j].access))
+				wave = std::max(wave, waveOf[j] + 1);
+		}
+
+		waveOf[i] = wave;
+
+		if (wave == waves.size())
+			waves.emplace_back();
+
+		waves[wave].push_back(i);
+	}
+
+	wavesDirty = false;
+}
+
+void SystemScheduler::add(EngineController* controller)
+{
+	systems.push_back({ controller, controller->getAccess() });
+	wavesDirty = true;
+}
+
+void SystemScheduler::remove(EngineController* controller)
+{
+	systems.erase(std::remove_if(systems.begin(), systems.end(), [controller](const System& system) { return system.controller == controller; }), systems.end());
+	wavesDirty = true;
+}
+
+void SystemScheduler::update(JobSystem& jobs)
+{
+	if (wavesDirty)
+		buildWaves();
+
+	for (const std::vector<size_t>& wave : waves)
+	{
+		// Nothing to share a single system with
+		if (wave.size() == 1)
+		{
+			systems[wave[0]].controller->update();
+			continue;
+		}
+
+		JobGroup group;
+		EngineController* keptForThisThread = nullptr;
+
+		for (size_t index : wave)
+		{
+			const System& system = systems[index];
+
+			// Systems that must stay on this thread run after the others are queued
+			if (system.access.mainThread)
+				continue;
+
+			// Keeps one system for this thread so it is not only waiting
+			if (keptForThisThread == nullptr)
+			{
+				keptForThisThread = system.controller;
+				continue;
+			}
+
+			EngineController* controller = system.controller;
+			jobs.submit(group, [controller]() { controller->update(); });
+		}
+
+		// The queued systems use the group so they are always waited for, even if a system on this thread throws
+		std::exception_ptr error;
+
+		try
+		{
+			for (size_t index : wave)
+			{
+				if (systems[index].access.mainThread)
+					systems[index].controller->update();
+			}
+
+			if (keptForThisThread != nullptr)
+				keptForThisThread->update();
+		}
+
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		// Runs queued systems while waiting for the rest of the wave
+		jobs.wait(group);
+
+		if (error != nullptr)
+			std::rethrow_exception(error);
+	}
+}
+
+void SystemScheduler::forEach(const std::function<void(EngineController&)>& function)
+{
+	for (System& system : systems)
+		function(*system.controller);
+}
+
+size_t SystemScheduler::getWaveCount()
+{
+	if (wavesDirty)
+		buildWaves();
+
+	return waves.size();
+}
@@ -0,0 +1,104 @@
+#include <engine/shapeCache.h>
+
+#include <cstring>
+
+std::string ShapeCache::makeKey(const Vec2* vertices, size_t count)
+{
+	std::string key(count * sizeof(float) * 2, '\0');
+
+	for (size_t i = 0; i < count; i++)
+	{
+		// Adding 0 turns -0 into 0 so they give the same key
+		float values[2] = { vertices[i].x + 0.0f, vertices[i].y + 0.0f };
+		std::memcpy(&key[i * sizeof(values)], values, sizeof(values));
+	}
+
+	return key;
+}
+
+std::shared_ptr<const Hitbox> ShapeCache::getHitbox(const std::vector<Vec2>& outline)
+{
+	std::string key = makeKey(outline.data(), outline.size());
+
+	// Returns the hitbox if it has already been created
+	auto found = hitboxes.find(key);
+
+	if (found != hitboxes.end())
+		return found->second;
+
+	// Allocated through the tracker so the cache shows up as its own category
+	std::shared_ptr<Hitbox> hitbox = std::allocate_shared<Hitbox>(TrackingAllocator<Hitbox, MemoryCategory::SHAPES>());
+	hitbox->outline = outline;
+
+	// Convex outlines are used as they are, anything else is split into convex pieces
+	if (outline.size() <= b2_maxPolygonVertices && isConvex(outline))
+		hitbox->pieces.push_back(get(outline));
+
+	else
+	{
+		for (const std::vector<Vec2>& piece : decompositions.get(outline, key))
+			hitbox->pieces.push_back(get(piece));
+	}
+
+	hitboxes[key] = hitbox;
+	return hitbox;
+}
+
+std::shared_ptr<b2PolygonShape> ShapeCache::get(const std::vector<Vec2>& vertices)
+{
+	std::string key = makeKey(vertices.data(), vertices.size());
+
+	// Returns the shape if it has already been created
+	auto found = shapes.find(key);
+
+	if (found != shapes.end())
+	{
+		hits++;
+		return found->second;
+	}
+
+	misses++;
+
+	// Creates the shape (computes the hull and centroid)
+	std::vector<b2Vec2> points(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+		points[i] = b2Vec2(vertices[i].x, vertices[i].y);
+
+	std::shared_ptr<b2PolygonShape> shape = std::allocate_shared<b2PolygonShape>(TrackingAllocator<b2PolygonShape, MemoryCategory::SHAPES>());
+	shape->Set(points.data(), (int32)points.size());
+
+	shapes[key] = shape;
+
+	// Also stores it under its hull so defs created from entities find it
+	std::vector<Vec2> hull(shape->m_vertices, shape->m_vertices + shape->m_count);
+	shapes.emplace(makeKey(hull.data(), hull.size()), shape);
+
+	return shape;
+}
+
+void ShapeCache::releaseUnused()
+{
+	// Removes the hitboxes first as they hold on to shapes
+	for (auto it = hitboxes.begin(); it != hitboxes.end();)
+		it = (it->second.use_count() == 1) ? hitboxes.erase(it) : std::next(it);
+
+	// Counts how many keys each shape is stored under (its own vertices and its hull)
+	std::unordered_map<b2PolygonShape*, long> cacheCounts;
+
+	for (const auto& item : shapes)
+		cacheCounts[item.second.get()]++;
+
+	// Finds every shape that nothing outside of the cache is holding (before erasing changes the use counts)
+	std::unordered_set<b2PolygonShape*> unused;
+
+	for (const auto& item : shapes)
+	{
+		if (item.second.use_count() == cacheCounts[item.second.get()])
+			unused.insert(item.second.get());
+	}
+
+	// Removes them under every key
+	for (auto it = shapes.begin(); it != shapes.end();)
+		it = (unused.count(it->second.get()) != 0) ? shapes.erase(it) : std::next(it);
+}
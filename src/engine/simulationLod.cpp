@@ -0,0 +1,125 @@
+#include <engine/simulationLod.h>
+
+#include <engine/entity.h>
+
+/*
+* @brief Moves the body of an entity into a tier
+*/
+static void setTier(PhysicalEntity* entity, b2Body* body, SimulationTier& current, SimulationTier tier)
+{
+	if (tier == current)
+		return;
+
+	// Disabling the body destroys its contacts (EndContact removes them from both contact maps)
+	if (tier == SimulationTier::FROZEN)
+	{
+		body->SetEnabled(false);
+		entity->getB2UserData()->grounded = false;
+	}
+
+	// Enabling it again creates its fixtures' proxies, the contacts come back on the next step through BeginContact
+	else if (current == SimulationTier::FROZEN)
+		body->SetEnabled(true);
+
+	// A body that was asleep between reduced steps is woken (preStepUpdate gives it back its velocity)
+	if (tier != SimulationTier::FROZEN)
+		body->SetAwake(true);
+
+	current = tier;
+}
+
+SimulationTier SimulationLOD::chooseTier(float distance, SimulationTier current) const
+{
+	// Moving out past a radius needs the extra hysteresis, coming back in does not
+	float reducedEdge = settings.reducedRadius + (current == SimulationTier::FULL ? settings.hysteresis : 0.0f);
+	float frozenEdge = settings.frozenRadius + (current != SimulationTier::FROZEN ? settings.hysteresis : 0.0f);
+
+	if (distance < reducedEdge)
+		return SimulationTier::FULL;
+
+	if (distance < frozenEdge)
+		return SimulationTier::REDUCED;
+
+	return SimulationTier::FROZEN;
+}
+
+void SimulationLOD::update(Vec2 focus, unsigned int intervalScale, size_t step)
+{
+	tierCounts = {};
+
+	unsigned int interval = std::max(settings.reducedInterval * std::max(intervalScale, 1u), 1u);
+	bool reducedStep = step % interval == 0;
+
+	for (std::unique_ptr<Entity>& instance : Entity::instances)
+	{
+		// Entities of a level still loading sit out every step and their bodies are left disabled
+		instance->skippedUpdate = instance->loading;
+
+		if (instance->loading)
+			continue;
+
+		// Only dynamic bodies are simulated less (static and kinematic bodies cost little and others rest on them)
+		if (instance->type != EntityType::GRAPHIC_PHYSICAL)
+			continue;
+
+		PhysicalEntity* entity = static_cast<PhysicalEntity*>(instance.get());
+		b2Body* body = entity->body;
+
+		if (body == nullptr || body->GetType() != b2_dynamicBody)
+			continue;
+
+		// Picks the tier (everything is simulated fully while the LOD is off)
+		SimulationTier tier = SimulationTier::FULL;
+
+		if (settings.enabled)
+			tier = chooseTier((entity->position - focus).length(), entity->simulationTier);
+
+		setTier(entity, body, entity->simulationTier, tier);
+		tierCounts[(size_t)tier]++;
+
+		// Frozen entities never update, reduced ones sleep through the steps they miss
+		if (tier == SimulationTier::FROZEN)
+			entity->skippedUpdate = true;
+
+		else if (tier == SimulationTier::REDUCED)
+		{
+			if (reducedStep)
+				body->SetAwake(true);
+
+			else
+			{
+				// Sleeping zeroes the body's velocity but the entity still has it from its last post step update
+				entity->skippedUpdate = true;
+				body->SetAwake(false);
+			}
+		}
+	}
+}
+
+void SimulationLOD::restoreAll()
+{
+	for (std::unique_ptr<Entity>& instance : Entity::instances)
+	{
+		instance->skippedUpdate = instance->loading;
+
+		if (instance->loading || instance->type != EntityType::GRAPHIC_PHYSICAL)
+			continue;
+
+		PhysicalEntity* entity = static_cast<PhysicalEntity*>(instance.get());
+
+		if (entity->body != nullptr)
+			setTier(entity, entity->body, entity->simulationTier, SimulationTier::FULL);
+	}
+
+	tierCounts = {};
+}
+
+void SimulationLOD::setSettings(const SimulationLODSettings& newSettings)
+{
+	bool wasEnabled = settings.enabled;
+	settings = newSettings;
+
+	// Gives every body back straight away so nothing stays frozen while the LOD is off
+	if (wasEnabled && !settings.enabled)
+		restoreAll();
+}
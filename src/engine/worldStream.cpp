@@ -0,0 +1,296 @@
+#include <engine/worldStream.h>
+
+#include <engine/entity.h>
+
+// Name of the index file written next to the chunks
+#define CHUNK_INDEX_FILE "chunks.json"
+
+static ChunkCoord getChunkOf(Vec2 position, float chunkSize)
+{
+	return { (int)std::floor(position.x / chunkSize), (int)std::floor(position.y / chunkSize) };
+}
+
+static std::string getChunkFileName(ChunkCoord coord)
+{
+	return "chunk_" + std::to_string(coord.x) + "_" + std::to_string(coord.y) + ".b2lv";
+}
+
+void splitLevelIntoChunks(const LevelDef& levelDef, const std::string& directory, float chunkSize)
+{
+	// Checks the chunk size is usable
+	if (chunkSize <= 0.0f)
+		throw std::runtime_error("Error: chunk size must be larger than 0");
+
+	// Puts each entity into the chunk its position is in
+	std::unordered_map<ChunkCoord, LevelDef, ChunkCoordHash> chunks;
+
+	for (const GraphicDef& def : levelDef.graphicEntities)
+		chunks[getChunkOf(def.position, chunkSize)].graphicEntities.push_back(def);
+
+	for (const PhysicalDef& def : levelDef.physicalEntities)
+		chunks[getChunkOf(def.position, chunkSize)].physicalEntities.push_back(def);
+
+	std::filesystem::create_directories(directory);
+
+	// Writes each chunk and adds it to the index
+	nl::json indexJson;
+	indexJson["chunkSize"] = chunkSize;
+	indexJson["chunks"] = nl::json::array();
+
+	for (const auto& chunk : chunks)
+	{
+		saveToBinary(chunk.second, (std::filesystem::path(directory) / getChunkFileName(chunk.first)).string());
+		indexJson["chunks"].push_back({ chunk.first.x, chunk.first.y });
+	}
+
+	// Writes the index
+	std::ofstream file(std::filesystem::path(directory) / CHUNK_INDEX_FILE);
+	file << indexJson.dump(-1);
+	file.close();
+}
+
+// --------------- StreamedWorld Member Functions --------------- //
+
+StreamedWorld::StreamedWorld(const std::string& directory, float loadRadius, float unloadRadius)
+	: directory(directory), loadRadius(loadRadius), unloadRadius(std::max(loadRadius, unloadRadius))
+{
+	// Opens the index
+	std::string indexPath = (std::filesystem::path(directory) / CHUNK_INDEX_FILE).string();
+	std::ifstream file(indexPath);
+
+	if (!file.is_open())
+		throw std::runtime_error("Error: could not open file " + indexPath);
+
+	// The index is small so it is fine to load it as a whole
+	nl::json indexJson;
+	file >> indexJson;
+
+	chunkSize = indexJson.at("chunkSize").get<float>();
+
+	if (chunkSize <= 0.0f)
+		throw std::runtime_error("Error: chunk size must be larger than 0");
+
+	// Checks that chunks is an array
+	if (!indexJson["chunks"].is_array())
+		throw std::runtime_error("Error: chunks is not an array in JSON file");
+
+	for (const auto& chunk : indexJson["chunks"])
+		chunkFiles.insert({ chunk.at(0).get<int>(), chunk.at(1).get<int>() });
+}
+
+StreamedWorld::~StreamedWorld()
+{
+	// Waits for the background threads (the results are thrown away)
+	callFuncOnMap(loadingChunks, [](const ChunkCoord&, std::future<LevelDef>& future) { future.wait(); });
+	callFuncOnMap(savingChunks, [](const ChunkCoord&, ChunkSave& save) { save.writing.wait(); });
+}
+
+std::string StreamedWorld::getChunkPath(ChunkCoord coord) const
+{
+	return (std::filesystem::path(directory) / getChunkFileName(coord)).string();
+}
+
+float StreamedWorld::distanceToChunk(ChunkCoord coord, Vec2 point) const
+{
+	// Finds the closest point of the chunk to the point
+	float left = (float)coord.x * chunkSize;
+	float top = (float)coord.y * chunkSize;
+
+	float closestX = std::min(std::max(point.x, left), left + chunkSize);
+	float closestY = std::min(std::max(point.y, top), top + chunkSize);
+
+	return std::sqrt((point.x - closestX) * (point.x - closestX) + (point.y - closestY) * (point.y - closestY));
+}
+
+void StreamedWorld::unloadChunk(ChunkCoord coord)
+{
+	Level& level = loadedChunks[coord];
+
+	// Turns the entities back into defs and destroys them (and their bodies)
+	LevelDef def;
+	def.graphicEntities.reserve(level.graphicEntities.size());
+	def.physicalEntities.reserve(level.physicalEntities.size());
+
+	std::unordered_set<Entity*> removed;
+	removed.reserve(level.graphicEntities.size() + level.physicalEntities.size());
+
+	for (GraphicEntity* entity : level.graphicEntities)
+	{
+		def.graphicEntities.push_back(createDefOf(entity));
+		removed.insert(entity);
+	}
+
+	for (PhysicalEntity* entity : level.physicalEntities)
+	{
+		def.physicalEntities.push_back(createDefOf(entity));
+		removed.insert(entity);
+	}
+
+	// One pass over Entity::instances for the whole chunk instead of one per entity
+	Entity::remove(removed);
+
+	loadedChunks.erase(coord);
+
+	// Writes the chunk back on a background thread
+	std::string path = getChunkPath(coord);
+
+	ChunkSave& save = savingChunks[coord];
+	save.def = std::make_shared<const LevelDef>(std::move(def));
+
+	save.writing = std::async(std::launch::async, [def = save.def, path]()
+	{
+		saveToBinary(*def, path);
+	});
+}
+
+void StreamedWorld::finishSave(ChunkCoord coord, ChunkSave& save)
+{
+	try
+	{
+		save.writing.get();
+	}
+
+	catch (const std::exception& error)
+	{
+		// Keeps the chunk in memory rather than losing it
+		std::cout << error.what() << std::endl;
+		unsavedChunks[coord] = save.def;
+	}
+}
+
+void StreamedWorld::update()
+{
+	// Returns true if the future has finished without blocking
+	auto isReady = [](auto& future) { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+
+	// Gets the centre of the view in meters
+	Vec2 center = engineInstance->getViewCenter();
+	center = Vec2(center.x / engineInstance->pxToMeter, center.y / engineInstance->pxToMeter);
+
+	// Finishes the chunks that have been written back (taken out of the map first so an error is only seen once)
+	for (auto it = savingChunks.begin(); it != savingChunks.end();)
+	{
+		if (!isReady(it->second.writing)) { it++; continue; }
+
+		ChunkCoord coord = it->first;
+		ChunkSave save = std::move(it->second);
+		it = savingChunks.erase(it);
+
+		finishSave(coord, save);
+	}
+
+	// Creates the entities of the chunks that have finished parsing (has to be on the main thread as it touches the b2World)
+	for (auto it = loadingChunks.begin(); it != loadingChunks.end();)
+	{
+		if (!isReady(it->second)) { it++; continue; }
+
+		ChunkCoord coord = it->first;
+		std::future<LevelDef> parsing = std::move(it->second);
+		it = loadingChunks.erase(it);
+
+		try
+		{
+			loadedChunks[coord] = loadLevel(parsing.get());
+		}
+
+		catch (const std::exception& error)
+		{
+			// Stops streaming the chunk so a broken file is not read again every frame
+			std::cout << error.what() << std::endl;
+			chunkFiles.erase(coord);
+		}
+	}
+
+	// Unloads the chunks that are too far away
+	std::vector<ChunkCoord> farChunks;
+
+	for (const auto& chunk : loadedChunks)
+	{
+		if (distanceToChunk(chunk.first, center) > unloadRadius)
+			farChunks.push_back(chunk.first);
+	}
+
+	for (ChunkCoord coord : farChunks)
+		unloadChunk(coord);
+
+	// Starts loading the chunks that are close enough
+	ChunkCoord min = getChunkOf(Vec2(center.x - loadRadius, center.y - loadRadius), chunkSize);
+	ChunkCoord max = getChunkOf(Vec2(center.x + loadRadius, center.y + loadRadius), chunkSize);
+
+	for (int y = min.y; y <= max.y; y++)
+	{
+		for (int x = min.x; x <= max.x; x++)
+		{
+			ChunkCoord coord = { x, y };
+
+			// Skips chunks with no file and chunks already loaded or loading
+			if (chunkFiles.count(coord) == 0 || inMap(loadedChunks, coord) || inMap(loadingChunks, coord))
+				continue;
+
+			// Waits for the chunk to finish being written back before reading it again
+			if (inMap(savingChunks, coord))
+				continue;
+
+			if (distanceToChunk(coord, center) > loadRadius)
+				continue;
+
+			// A chunk whose write failed is still in memory and newer than its file
+			auto unsaved = unsavedChunks.find(coord);
+
+			if (unsaved != unsavedChunks.end())
+			{
+				loadedChunks[coord] = loadLevel(*unsaved->second);
+				unsavedChunks.erase(unsaved);
+				continue;
+			}
+
+			loadingChunks[coord] = std::async(std::launch::async, loadBinaryLevelDef, getChunkPath(coord));
+		}
+	}
+}
+
+void StreamedWorld::render()
+{
+	// Renders every entity of every loaded chunk
+	for (auto& chunk : loadedChunks)
+	{
+		for (GraphicEntity* entity : chunk.second.graphicEntities)
+			entity->render();
+
+		for (PhysicalEntity* entity : chunk.second.physicalEntities)
+			entity->render();
+	}
+}
+
+void StreamedWorld::close()
+{
+	// Unloads every loaded chunk
+	while (!loadedChunks.empty())
+		unloadChunk(loadedChunks.begin()->first);
+
+	// Waits for everything to be written
+	callFuncOnMap(savingChunks, [this](const ChunkCoord& coord, ChunkSave& save) { finishSave(coord, save); });
+	savingChunks.clear();
+
+	// Tries once more to write the chunks whose write failed
+	for (const auto& unsaved : unsavedChunks)
+	{
+		try
+		{
+			saveToBinary(*unsaved.second, getChunkPath(unsaved.first));
+		}
+
+		catch (const std::exception& error)
+		{
+			std::cout << error.what() << std::endl;
+		}
+	}
+
+	unsavedChunks.clear();
+
+	// Throws away chunks that were still being parsed
+	callFuncOnMap(loadingChunks, [](const ChunkCoord&, std::future<LevelDef>& future) { future.wait(); });
+	loadingChunks.clear();
+}
+
+#undef CHUNK_INDEX_FILE
@@ -10,6 +10,8 @@ class CustomController : public EngineController
 
 		Level testLevel;
 
+		LevelSaver testLevelSaver;
+
 	public:
 		void init() override
 		{
@@ -73,18 +75,18 @@ class CustomController : public EngineController
 
 			//
 
-			if (engineInstance->isPressed(sf::Keyboard::W) && player->getB2UserData()->grounded)
+			if (engineInstance->isActionPressed("jump") && player->getB2UserData()->grounded)
 			{
 				player->setYVelocity(-20);
 			}
 
 			float newXVel = 0;
-			newXVel = newXVel - (engineInstance->isPressed(sf::Keyboard::A) * 5);
-			newXVel = newXVel + (engineInstance->isPressed(sf::Keyboard::D) * 5);
+			newXVel = newXVel - (engineInstance->isActionPressed("moveLeft") * 5);
+			newXVel = newXVel + (engineInstance->isActionPressed("moveRight") * 5);
 
 			player->setXVelocity(newXVel);
 
-			if (engineInstance->isClicked(sf::Keyboard::R))
+			if (engineInstance->isActionClicked("respawn"))
 			{
 				PhysicalDef newPlayerDef;
 
@@ -98,29 +100,29 @@ class CustomController : public EngineController
 
 		void close() override
 		{
-			saveToJson(testLevel, "C:/Users/Pasha/source/github-repos/Box2D-Game-Engine/levels/exampleLevel.json");
+			testLevelSaver.save(testLevel, "C:/Users/Pasha/source/github-repos/Box2D-Game-Engine/levels/exampleLevel.json");
+			testLevelSaver.wait();
 		}
 };
 
 int main()
 {
 	Engine instance(Vec2{ 1280, 720 }, std::make_unique<CustomController>());
-	//instance.testShader.loadFromFile("C:/Users/Pasha/source/github-repos/Box2D-Game-Engine/glsl/blur.frag", sf::Shader::Fragment);
+	//instance.setPostProcessShader("glsl/blur.frag");
+	//instance.metrics.openSocket("/tmp/engine-metrics.sock");
 
 	instance.addInputs(
 		sf::Keyboard::Left,
 		sf::Keyboard::Right,
 		sf::Keyboard::Up,
-		sf::Keyboard::Down,
-
-		sf::Keyboard::W,
-		sf::Keyboard::A,
-		sf::Keyboard::S,
-		sf::Keyboard::D,
-
-		sf::Keyboard::R
+		sf::Keyboard::Down
 	);
 
+	instance.bindAction("jump", sf::Keyboard::W);
+	instance.bindAction("moveLeft", sf::Keyboard::A);
+	instance.bindAction("moveRight", sf::Keyboard::D);
+	instance.bindAction("respawn", sf::Keyboard::R);
+
 	BASIC_LOOP(instance);
 
 	return 0;
@@ -0,0 +1,121 @@
+#include <util/mappedFile.h>
+
+#include <util/libs.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+	// Opens the file
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		fileHandle = nullptr;
+		throw std::runtime_error("Error: could not open file " + path);
+	}
+
+	// Gets the size of the file
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	size = (size_t)fileSize.QuadPart;
+
+	// Empty files can not be mapped
+	if (size == 0)
+		return;
+
+	// Maps the file
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mappingHandle != nullptr)
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+	if (data == nullptr)
+	{
+		close();
+		throw std::runtime_error("Error: could not map file " + path);
+	}
+}
+
+void MappedFile::close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	data = nullptr;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+	// Opens the file
+	fileDescriptor = open(path.c_str(), O_RDONLY);
+
+	if (fileDescriptor == -1)
+		throw std::runtime_error("Error: could not open file " + path);
+
+	// Gets the size of the file
+	struct stat fileInfo;
+
+	if (fstat(fileDescriptor, &fileInfo) != 0)
+	{
+		close();
+		throw std::runtime_error("Error: could not read size of file " + path);
+	}
+
+	size = (size_t)fileInfo.st_size;
+
+	// Empty files can not be mapped
+	if (size == 0)
+		return;
+
+	// Maps the file
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+	if (mapping == MAP_FAILED)
+	{
+		close();
+		throw std::runtime_error("Error: could not map file " + path);
+	}
+
+	data = static_cast<const uint8_t*>(mapping);
+}
+
+void MappedFile::close()
+{
+	if (data != nullptr)
+		munmap(const_cast<uint8_t*>(data), size);
+
+	if (fileDescriptor != -1)
+		::close(fileDescriptor);
+
+	data = nullptr;
+	fileDescriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
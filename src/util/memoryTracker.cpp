@@ -0,0 +1,126 @@
+#include <util/memoryTracker.h>
+
+#include <cstdlib>
+#include <iomanip>
+
+std::array<MemoryTracker::Counters, (size_t)MemoryCategory::COUNT> MemoryTracker::counters;
+
+std::atomic<bool> MemoryTracker::box2DHooked{ false };
+
+// Size of the header box2DAlloc puts before each block (keeps the block aligned for any type)
+static constexpr size_t BOX2D_HEADER_SIZE = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+void MemoryTracker::allocated(MemoryCategory category, size_t bytes)
+{
+	Counters& counter = counters[(size_t)category];
+
+	size_t current = counter.currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	counter.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	counter.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	// Raises the peak if this is the most that has been in use
+	size_t peak = counter.peakBytes.load(std::memory_order_relaxed);
+
+	while (current > peak && !counter.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+}
+
+void MemoryTracker::freed(MemoryCategory category, size_t bytes)
+{
+	counters[(size_t)category].currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::endFrame()
+{
+	for (Counters& counter : counters)
+		counter.lastFrameAllocations = counter.frameAllocations.exchange(0, std::memory_order_relaxed);
+}
+
+MemoryStats MemoryTracker::getStats(MemoryCategory category)
+{
+	const Counters& counter = counters[(size_t)category];
+
+	MemoryStats stats;
+	stats.currentBytes = counter.currentBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = counter.peakBytes.load(std::memory_order_relaxed);
+	stats.totalAllocations = counter.totalAllocations.load(std::memory_order_relaxed);
+	stats.frameAllocations = counter.lastFrameAllocations.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+const char* MemoryTracker::getName(MemoryCategory category)
+{
+	switch (category)
+	{
+		case MemoryCategory::ENTITIES: return "Entities";
+		case MemoryCategory::USER_DATA: return "User data";
+		case MemoryCategory::BOX2D: return "Box2D";
+		case MemoryCategory::SHAPES: return "Shapes";
+		case MemoryCategory::RENDER_TEXTURES: return "Render textures";
+		case MemoryCategory::LEVEL_DEFS: return "Level defs";
+		case MemoryCategory::ASSETS: return "Assets";
+		case MemoryCategory::PARTICLES: return "Particles";
+		default: return "Unknown";
+	}
+}
+
+void MemoryTracker::dump(std::ostream& stream)
+{
+	stream << std::left << std::setw(18) << "Category" << std::right
+		<< std::setw(14) << "Current KB" << std::setw(14) << "Peak KB"
+		<< std::setw(12) << "Allocs" << std::setw(14) << "Allocs/frame" << "\n";
+
+	for (size_t i = 0; i < (size_t)MemoryCategory::COUNT; i++)
+	{
+		MemoryCategory category = (MemoryCategory)i;
+		MemoryStats stats = getStats(category);
+
+		stream << std::left << std::setw(18) << getName(category) << std::right
+			<< std::setw(14) << stats.currentBytes / 1024 << std::setw(14) << stats.peakBytes / 1024
+			<< std::setw(12) << stats.totalAllocations << std::setw(14) << stats.frameAllocations << "\n";
+	}
+
+	if (!isBox2DHooked())
+		stream << "(Box2D was built without B2_USER_SETTINGS so its memory is not counted)\n";
+
+	stream << std::flush;
+}
+
+void* MemoryTracker::box2DAlloc(size_t bytes)
+{
+	box2DHooked = true;
+
+	// Stores the size in front of the block as b2Free is not given it
+	char* block = static_cast<char*>(std::malloc(bytes + BOX2D_HEADER_SIZE));
+
+	if (block == nullptr)
+		return nullptr;
+
+	*reinterpret_cast<size_t*>(block) = bytes;
+	allocated(MemoryCategory::BOX2D, bytes);
+
+	return block + BOX2D_HEADER_SIZE;
+}
+
+void MemoryTracker::box2DFree(void* memory)
+{
+	if (memory == nullptr)
+		return;
+
+	char* block = static_cast<char*>(memory) - BOX2D_HEADER_SIZE;
+
+	freed(MemoryCategory::BOX2D, *reinterpret_cast<size_t*>(block));
+	std::free(block);
+}
+
+// Hooks declared in b2_user_settings.h
+
+void* b2TrackedAlloc(int32 size)
+{
+	return MemoryTracker::box2DAlloc((size_t)size);
+}
+
+void b2TrackedFree(void* memory)
+{
+	MemoryTracker::box2DFree(memory);
+}
@@ -0,0 +1,65 @@
+// Level converter
+//
+// Converts levels between the JSON format (used for editing) and the binary format (used for loading).
+// The direction is picked from the input file: binary levels are converted to JSON and anything else
+// is read as JSON and converted to binary.
+//
+// Build with every file in src/ except src/main.cpp.
+//
+// With --chunks the level is instead split into a directory of binary chunks for StreamedWorld.
+//
+// Usage: levelConverter <input> <output>
+//        levelConverter --chunks <chunk size> <input> <output directory>
+
+#include <util/util.h>
+#include <engine/level.h>
+#include <engine/levelBinary.h>
+#include <engine/worldStream.h>
+
+int main(int argc, char** argv)
+{
+	bool chunks = argc == 5 && std::string(argv[1]) == "--chunks";
+
+	if (argc != 3 && !chunks)
+	{
+		std::cout << "Usage: levelConverter <input> <output>" << std::endl;
+		std::cout << "       levelConverter --chunks <chunk size> <input> <output directory>" << std::endl;
+		return 2;
+	}
+
+	std::string inputPath = argv[chunks ? 3 : 1];
+	std::string outputPath = argv[chunks ? 4 : 2];
+
+	try
+	{
+		// Splits the level into chunks
+		if (chunks)
+		{
+			LevelDef def = loadLevelDef(inputPath);
+			splitLevelIntoChunks(def, outputPath, std::stof(argv[2]));
+
+			std::cout << "Split " << def.graphicEntities.size() << " graphic and " << def.physicalEntities.size() << " physical entities into chunks" << std::endl;
+			return 0;
+		}
+
+		// Loads the level (loadLevelDef reads either format)
+		LevelDef def = loadLevelDef(inputPath);
+
+		// Saves it in the other format
+		if (isBinaryLevel(inputPath))
+			saveToJson(def, outputPath);
+
+		else
+			saveToBinary(def, outputPath);
+
+		std::cout << "Converted " << def.graphicEntities.size() << " graphic and " << def.physicalEntities.size() << " physical entities" << std::endl;
+	}
+
+	catch (const std::exception& error)
+	{
+		std::cout << error.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,489 @@
+// Performance regression harness
+//
+// Steps a fixed set of scenarios through the real Engine::update path without rendering (the example level,
+// box stacks, a box pile, a large streamed map and editor picking) and compares the median and p99 step times
+// and the allocations per step against a checked-in baseline file. Levels are created with loadLevel and
+// StreamedWorld as the game creates them.
+//
+// Build with every file in src/ except src/main.cpp. Run it from the root of the repository.
+//
+// The baseline has to be recorded on the machine the harness is run on (step times are not comparable across
+// machines): run with --record, check the file in, and run without it to compare. Without a baseline file the
+// results are only reported and the harness succeeds, unless --require-baseline is given (for CI machines that
+// have recorded one).
+//
+// Usage: perfRegression [--steps N] [--warmup N] [--threshold FRACTION] [--baseline FILE] [--level FILE]
+//                       [--scenario NAME] [--record] [--require-baseline]
+// Returns non-zero if any scenario is slower or allocates more than its baseline allows
+
+#include <util/util.h>
+#include <engine/engine.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <new>
+
+// --------------- Allocation Counting --------------- //
+
+// Every allocation made through operator new by any thread (the engine, the job system and the standard library)
+static std::atomic<size_t> allocationCount{ 0 };
+
+void* operator new(size_t bytes)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* memory = std::malloc(bytes == 0 ? 1 : bytes))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+/*
+* @brief Gets the number of allocations made so far (Box2D's are included when it is built with B2_USER_SETTINGS)
+*/
+static size_t getAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed) + MemoryTracker::getStats(MemoryCategory::BOX2D).totalAllocations;
+}
+
+// --------------- Scenarios --------------- //
+
+/*
+* @brief A fixed workload the harness steps
+*/
+struct Scenario
+{
+	std::string name;
+
+	// Creates the entities (called from the controller's init, once the engine exists)
+	std::function<void()> init;
+
+	// Work done every step on top of the engine's own (optional, runs inside Engine::update)
+	std::function<void(Engine&, int)> step;
+
+	// Called before the engine closes (optional)
+	std::function<void()> close;
+};
+
+/*
+* @brief Controller that runs a scenario
+*/
+class ScenarioController : public EngineController
+{
+	private:
+		const Scenario& scenario;
+		int stepIndex = 0;
+
+	public:
+		ScenarioController(const Scenario& scenario) : scenario(scenario) {}
+
+		void init() override
+		{
+			scenario.init();
+		}
+
+		void update() override
+		{
+			if (scenario.step)
+				scenario.step(*engineInstance, stepIndex);
+
+			stepIndex++;
+		}
+
+		void close() override
+		{
+			if (scenario.close)
+				scenario.close();
+		}
+};
+
+static PhysicalDef makeBox(Vec2 position, Vec2 halfSize, b2BodyType type)
+{
+	PhysicalDef def;
+	def.position = position;
+	def.size = halfSize;
+	def.bodyType = type;
+
+	def.fixtureVertices.push_back({
+		Vec2(-halfSize.x, -halfSize.y),
+		Vec2(halfSize.x, -halfSize.y),
+		Vec2(halfSize.x, halfSize.y),
+		Vec2(-halfSize.x, halfSize.y)
+	});
+
+	return def;
+}
+
+static Scenario makeExampleLevelScenario(const std::string& levelPath)
+{
+	Scenario scenario;
+	scenario.name = "example-level";
+	scenario.init = [levelPath]() { loadLevel(levelPath); };
+
+	return scenario;
+}
+
+static Scenario makeStacksScenario(int columns, int height)
+{
+	Scenario scenario;
+	scenario.name = "stacks";
+
+	scenario.init = [columns, height]()
+	{
+		LevelDef level;
+
+		// Ground under every column (positive y is down)
+		level.physicalEntities.push_back(makeBox(Vec2(0.0f, 5.0f), Vec2((float)columns, 0.5f), b2_staticBody));
+
+		// Columns of boxes resting on each other
+		for (int x = 0; x < columns; x++)
+		{
+			for (int y = 0; y < height; y++)
+				level.physicalEntities.push_back(makeBox(Vec2((float)x * 1.5f - (float)columns * 0.75f, 4.25f - (float)y * 0.5f), Vec2(0.25f), b2_dynamicBody));
+		}
+
+		loadLevel(level);
+	};
+
+	return scenario;
+}
+
+static Scenario makePileScenario(int count)
+{
+	Scenario scenario;
+	scenario.name = "pile";
+
+	scenario.init = [count]()
+	{
+		LevelDef level;
+
+		// A container for the boxes to fall into
+		level.physicalEntities.push_back(makeBox(Vec2(0.0f, 6.0f), Vec2(8.0f, 0.5f), b2_staticBody));
+		level.physicalEntities.push_back(makeBox(Vec2(-8.0f, 0.0f), Vec2(0.5f, 6.0f), b2_staticBody));
+		level.physicalEntities.push_back(makeBox(Vec2(8.0f, 0.0f), Vec2(0.5f, 6.0f), b2_staticBody));
+
+		// Boxes spread above it (a fixed pattern so every run is the same)
+		for (int i = 0; i < count; i++)
+			level.physicalEntities.push_back(makeBox(Vec2((float)(i % 30) * 0.5f - 7.25f, 4.0f - (float)(i / 30) * 0.5f), Vec2(0.2f), b2_dynamicBody));
+
+		loadLevel(level);
+	};
+
+	return scenario;
+}
+
+static Scenario makeStreamedMapScenario(const std::string& directory, int width, int height)
+{
+	Scenario scenario;
+	scenario.name = "streamed-map";
+
+	// Writes the chunks once before the engine exists so splitting is not measured
+	LevelDef level;
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			Vec2 position((float)x - 20.0f, (float)y - (float)height / 2.0f);
+
+			if ((x + y) % 3 == 0)
+				level.physicalEntities.push_back(makeBox(position, Vec2(0.4f), b2_staticBody));
+
+			else
+			{
+				GraphicDef def;
+				def.position = position;
+				def.size = Vec2(0.4f);
+
+				level.graphicEntities.push_back(def);
+			}
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+	splitLevelIntoChunks(level, directory, 16.0f);
+
+	std::shared_ptr<std::unique_ptr<StreamedWorld>> world = std::make_shared<std::unique_ptr<StreamedWorld>>();
+
+	scenario.init = [world, directory]() { *world = std::make_unique<StreamedWorld>(directory, 30.0f, 40.0f); };
+
+	// Pans across the map half a meter a step so chunks keep loading and unloading
+	scenario.step = [world](Engine& engine, int)
+	{
+		engine.moveView(Vec2(0.5f * Engine::pxToMeter, 0.0f));
+		(*world)->update();
+	};
+
+	scenario.close = [world]()
+	{
+		(*world)->close();
+		world->reset();
+	};
+
+	return scenario;
+}
+
+static Scenario makeEditorPickingScenario(int columns, int rows, int picksPerStep)
+{
+	Scenario scenario;
+	scenario.name = "editor-picking";
+
+	scenario.init = [columns, rows]()
+	{
+		LevelDef level;
+
+		for (int y = 0; y < rows; y++)
+		{
+			for (int x = 0; x < columns; x++)
+				level.physicalEntities.push_back(makeBox(Vec2((float)x * 0.5f, (float)y * 0.5f), Vec2(0.2f), b2_staticBody));
+		}
+
+		loadLevel(level);
+	};
+
+	// Picks at points spread over the grid (a fixed sequence so every run is the same)
+	scenario.step = [columns, rows, picksPerStep](Engine& engine, int step)
+	{
+		uint32_t state = 12345u + (uint32_t)step;
+
+		for (int i = 0; i < picksPerStep; i++)
+		{
+			state = state * 1664525u + 1013904223u;
+			float x = (float)(state >> 8 & 0xFFFF) / 65535.0f * (float)columns * 0.5f;
+			float y = (float)(state >> 16 & 0xFFFF) / 65535.0f * (float)rows * 0.5f;
+
+			engine.pickEntities(Vec2(x, y));
+		}
+	};
+
+	return scenario;
+}
+
+// --------------- Measuring --------------- //
+
+/*
+* @brief What a scenario measured (also what the baseline stores)
+*/
+struct ScenarioResult
+{
+	float medianMs = 0.0f;
+	float p99Ms = 0.0f;
+	float allocationsPerStep = 0.0f;
+};
+
+static float percentile(std::vector<float> samples, float fraction)
+{
+	if (samples.empty())
+		return 0.0f;
+
+	size_t index = std::min((size_t)(fraction * (float)samples.size()), samples.size() - 1);
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+	return samples[index];
+}
+
+static ScenarioResult runScenario(const Scenario& scenario, int steps, int warmup)
+{
+	Engine engine(Vec2{ 1280, 720 }, std::make_unique<ScenarioController>(scenario), WindowMode::OFFSCREEN);
+
+	// Pins full quality so a slow run does not lower the solver iterations or throttle far bodies and hide regressions
+	engine.governor.setEnabled(false);
+
+	SimulationLODSettings fullSimulation;
+	fullSimulation.enabled = false;
+	engine.simulationLOD.setSettings(fullSimulation);
+
+	// Lets the bodies settle and the caches fill so only the steady state is measured
+	for (int i = 0; i < warmup; i++)
+		engine.update();
+
+	std::vector<float> stepTimes;
+	stepTimes.reserve(steps);
+
+	size_t allocationsBefore = getAllocationCount();
+
+	for (int i = 0; i < steps; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		engine.update();
+		auto end = std::chrono::steady_clock::now();
+
+		stepTimes.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+	}
+
+	ScenarioResult result;
+	result.medianMs = percentile(stepTimes, 0.50f);
+	result.p99Ms = percentile(stepTimes, 0.99f);
+	result.allocationsPerStep = (float)(getAllocationCount() - allocationsBefore) / (float)steps;
+
+	return result;
+}
+
+/*
+* @brief Checks a measurement against its baseline
+*
+* @return Whether it is within the threshold
+*/
+static bool compare(const std::string& label, float value, float baseline, float threshold, float slack)
+{
+	// Allowed to be slower by the threshold (or by the slack, whichever is larger, so tiny baselines are not flaky)
+	float limit = std::max(baseline * (1.0f + threshold), baseline + slack);
+	bool passed = value <= limit;
+
+	std::cout << "  " << label << " " << value << " (baseline " << baseline << ", limit " << limit << ")"
+		<< (passed ? "" : " REGRESSION") << std::endl;
+
+	return passed;
+}
+
+int main(int argc, char** argv)
+{
+	// Parses the arguments
+	int steps = 600;
+	int warmup = 120;
+	float threshold = 0.15f;
+	std::string baselinePath = "tools/perfBaseline.json";
+	std::string levelPath = "levels/exampleLevel.json";
+	std::string onlyScenario;
+	bool record = false;
+	bool requireBaseline = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--steps" && i + 1 < argc)
+			steps = std::max(std::stoi(argv[++i]), 1);
+
+		else if (arg == "--warmup" && i + 1 < argc)
+			warmup = std::max(std::stoi(argv[++i]), 0);
+
+		else if (arg == "--threshold" && i + 1 < argc)
+			threshold = std::max(std::stof(argv[++i]), 0.0f);
+
+		else if (arg == "--baseline" && i + 1 < argc)
+			baselinePath = argv[++i];
+
+		else if (arg == "--level" && i + 1 < argc)
+			levelPath = argv[++i];
+
+		else if (arg == "--scenario" && i + 1 < argc)
+			onlyScenario = argv[++i];
+
+		else if (arg == "--record")
+			record = true;
+
+		else if (arg == "--require-baseline")
+			requireBaseline = true;
+
+		else
+		{
+			std::cout << "Usage: perfRegression [--steps N] [--warmup N] [--threshold FRACTION] [--baseline FILE] [--level FILE]" << std::endl;
+			std::cout << "                      [--scenario NAME] [--record] [--require-baseline]" << std::endl;
+			return 2;
+		}
+	}
+
+	std::vector<Scenario> scenarios;
+	scenarios.push_back(makeExampleLevelScenario(levelPath));
+	scenarios.push_back(makeStacksScenario(20, 15));
+	scenarios.push_back(makePileScenario(900));
+	scenarios.push_back(makeStreamedMapScenario((std::filesystem::temp_directory_path() / "perfRegression-chunks").string(), 400, 60));
+	scenarios.push_back(makeEditorPickingScenario(100, 100, 200));
+
+	// Reads the baseline (kept when recording so recording one scenario does not lose the others)
+	nl::json baseline = nl::json::object();
+	std::ifstream baselineFile(baselinePath);
+
+	// Without a baseline the results are only reported (none is checked in as it depends on the machine)
+	bool reportOnly = false;
+
+	if (baselineFile.is_open())
+		baseline = nl::json::parse(baselineFile);
+
+	else if (!record)
+	{
+		std::cout << "Missing baseline " << baselinePath << " (run with --record)" << std::endl;
+
+		if (requireBaseline)
+			return 1;
+
+		std::cout << "Only reporting the results" << std::endl;
+		reportOnly = true;
+	}
+
+	baselineFile.close();
+
+	// Step times are only allowed to grow by the threshold, allocations also by one per step
+	constexpr float TIME_SLACK_MS = 0.01f;
+	constexpr float ALLOCATION_SLACK = 1.0f;
+
+	bool failed = false;
+
+	for (const Scenario& scenario : scenarios)
+	{
+		if (!onlyScenario.empty() && scenario.name != onlyScenario)
+			continue;
+
+		ScenarioResult result = runScenario(scenario, steps, warmup);
+
+		std::cout << scenario.name
+			<< ": median " << result.medianMs << " ms"
+			<< ", p99 " << result.p99Ms << " ms"
+			<< ", allocations per step " << result.allocationsPerStep << std::endl;
+
+		if (record)
+		{
+			baseline[scenario.name] = {
+				{ "medianMs", result.medianMs },
+				{ "p99Ms", result.p99Ms },
+				{ "allocationsPerStep", result.allocationsPerStep }
+			};
+
+			continue;
+		}
+
+		if (reportOnly)
+			continue;
+
+		if (!baseline.contains(scenario.name))
+		{
+			std::cout << "  missing from the baseline (run with --record)" << std::endl;
+			failed = true;
+			continue;
+		}
+
+		const nl::json& expected = baseline[scenario.name];
+
+		failed |= !compare("median ms", result.medianMs, expected["medianMs"].get<float>(), threshold, TIME_SLACK_MS);
+		failed |= !compare("p99 ms", result.p99Ms, expected["p99Ms"].get<float>(), threshold, TIME_SLACK_MS);
+		failed |= !compare("allocations per step", result.allocationsPerStep, expected["allocationsPerStep"].get<float>(), threshold, ALLOCATION_SLACK);
+	}
+
+	// Writes the new baseline
+	if (record)
+	{
+		std::ofstream file(baselinePath);
+
+		if (!file.is_open())
+			throw std::runtime_error("Error: could not write baseline " + baselinePath);
+
+		file << baseline.dump(4) << std::endl;
+		std::cout << "Recorded baseline " << baselinePath << std::endl;
+
+		return 0;
+	}
+
+	return failed ? 1 : 0;
+}
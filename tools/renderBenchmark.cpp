@@ -0,0 +1,290 @@
+// Render benchmark and golden image test
+//
+// Renders generated levels through the full Engine::render path without a window and reports the frame
+// time and draw calls of each scene. The last frame of each scene is compared against a golden image.
+//
+// Build with every file in src/ except src/main.cpp. On machines without a GPU run it on Mesa's software
+// renderer (LIBGL_ALWAYS_SOFTWARE=1, and Xvfb if there is no display server).
+//
+// Frame times are taken after glFinish, so they include the GPU (or software rasteriser) finishing the frame.
+//
+// Golden images depend on the GPU and driver so none are checked in: run with --update-golden on the machine the
+// benchmark is run on. A scene without a golden image is only reported, unless --require-golden is given (for CI
+// machines that have recorded them).
+//
+// Usage: renderBenchmark [--frames N] [--golden DIRECTORY] [--update-golden] [--require-golden]
+// Returns non-zero if any frame does not match its golden image
+
+#include <util/util.h>
+#include <engine/engine.h>
+
+#include <algorithm>
+#include <chrono>
+
+/*
+* @brief Generated level the benchmark renders
+*/
+struct BenchmarkScene
+{
+	std::string name;
+	LevelDef level;
+};
+
+/*
+* @brief Controller that renders every entity of the level it is given
+*/
+class BenchmarkController : public EngineController
+{
+	private:
+		const LevelDef& levelDef;
+		Level level;
+
+	public:
+		BenchmarkController(const LevelDef& levelDef) : levelDef(levelDef) {}
+
+		void init() override
+		{
+			level = loadLevel(levelDef);
+		}
+
+		void render() override
+		{
+			for (GraphicEntity* entity : level.graphicEntities)
+				entity->render();
+
+			for (PhysicalEntity* entity : level.physicalEntities)
+				entity->render();
+		}
+};
+
+static PhysicalDef makeBox(Vec2 position, Vec2 halfSize, b2BodyType type)
+{
+	PhysicalDef def;
+	def.position = position;
+	def.size = halfSize;
+	def.bodyType = type;
+
+	def.fixtureVertices.push_back({
+		Vec2(-halfSize.x, -halfSize.y),
+		Vec2(halfSize.x, -halfSize.y),
+		Vec2(halfSize.x, halfSize.y),
+		Vec2(-halfSize.x, halfSize.y)
+	});
+
+	return def;
+}
+
+static BenchmarkScene makeGridScene(const std::string& name, int columns, int rows)
+{
+	BenchmarkScene scene;
+	scene.name = name;
+
+	// Fills the view with a grid of small background tiles and static blocks
+	for (int y = 0; y < rows; y++)
+	{
+		for (int x = 0; x < columns; x++)
+		{
+			Vec2 position((float)x * 0.5f - 6.0f, (float)y * 0.5f - 4.0f);
+
+			if ((x + y) % 2 == 0)
+			{
+				GraphicDef def;
+				def.position = position;
+				def.size = Vec2(0.2f);
+				def.layer = -1;
+
+				scene.level.graphicEntities.push_back(def);
+			}
+
+			else
+				scene.level.physicalEntities.push_back(makeBox(position, Vec2(0.2f), b2_staticBody));
+		}
+	}
+
+	return scene;
+}
+
+static BenchmarkScene makeLayeredScene(const std::string& name, int count)
+{
+	BenchmarkScene scene;
+	scene.name = name;
+
+	// Overlapping entities spread over many layers and depths so the sort has work to do
+	for (int i = 0; i < count; i++)
+	{
+		GraphicDef def;
+		def.position = Vec2((float)(i % 40) * 0.3f - 6.0f, (float)(i / 40 % 30) * 0.3f - 4.0f);
+		def.size = Vec2(0.4f);
+		def.layer = i % 7 - 3;
+		def.depth = (float)(i % 13);
+
+		scene.level.graphicEntities.push_back(def);
+	}
+
+	return scene;
+}
+
+static float percentile(std::vector<float> samples, float fraction)
+{
+	if (samples.empty())
+		return 0.0f;
+
+	size_t index = std::min((size_t)(fraction * (float)samples.size()), samples.size() - 1);
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+	return samples[index];
+}
+
+/*
+* @brief Compares two images allowing small differences between GL implementations
+*
+* @return Fraction of pixels that are different
+*/
+static float compareImages(const sf::Image& a, const sf::Image& b)
+{
+	Vec2 sizeA = a.getSize();
+	Vec2 sizeB = b.getSize();
+
+	// Different sizes never match
+	if (sizeA.x != sizeB.x || sizeA.y != sizeB.y)
+		return 1.0f;
+
+	constexpr int CHANNEL_TOLERANCE = 8;
+
+	const sf::Uint8* pixelsA = a.getPixelsPtr();
+	const sf::Uint8* pixelsB = b.getPixelsPtr();
+	size_t pixelCount = (size_t)sizeA.x * (size_t)sizeA.y;
+	size_t different = 0;
+
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		for (size_t c = 0; c < 4; c++)
+		{
+			if (std::abs((int)pixelsA[i * 4 + c] - (int)pixelsB[i * 4 + c]) > CHANNEL_TOLERANCE)
+			{
+				different++;
+				break;
+			}
+		}
+	}
+
+	return (float)different / (float)pixelCount;
+}
+
+int main(int argc, char** argv)
+{
+	// Parses the arguments
+	int frames = 300;
+	std::string goldenDirectory = "tools/golden";
+	bool updateGolden = false;
+	bool requireGolden = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--frames" && i + 1 < argc)
+			frames = std::max(std::stoi(argv[++i]), 1);
+
+		else if (arg == "--golden" && i + 1 < argc)
+			goldenDirectory = argv[++i];
+
+		else if (arg == "--update-golden")
+			updateGolden = true;
+
+		else if (arg == "--require-golden")
+			requireGolden = true;
+
+		else
+		{
+			std::cout << "Usage: renderBenchmark [--frames N] [--golden DIRECTORY] [--update-golden] [--require-golden]" << std::endl;
+			return 2;
+		}
+	}
+
+	std::vector<BenchmarkScene> scenes;
+	scenes.push_back(makeGridScene("grid-1k", 40, 25));
+	scenes.push_back(makeGridScene("grid-10k", 125, 80));
+	scenes.push_back(makeLayeredScene("layers-5k", 5000));
+
+	// Allowed fraction of different pixels before a frame counts as a regression
+	constexpr float MAX_DIFFERENCE = 0.001f;
+
+	bool failed = false;
+
+	for (const BenchmarkScene& scene : scenes)
+	{
+		Engine engine(Vec2{ 1280, 720 }, std::make_unique<BenchmarkController>(scene.level), WindowMode::OFFSCREEN);
+
+		// Pins full quality so slow frames do not turn off the debug drawing part way through (changing the draws and the golden image)
+		engine.governor.setEnabled(false);
+
+		SimulationLODSettings fullSimulation;
+		fullSimulation.enabled = false;
+		engine.simulationLOD.setSettings(fullSimulation);
+
+		// Only the last frame is read back (reading back is slow and would be included in the frame time)
+		engine.setReadbackInterval((unsigned int)frames);
+
+		std::vector<float> frameTimes;
+		frameTimes.reserve(frames);
+
+		for (int i = 0; i < frames; i++)
+		{
+			engine.update();
+
+			auto start = std::chrono::steady_clock::now();
+			engine.render();
+
+			// Waits for the GPU so the frame time includes the drawing and not only the submission of the commands
+			engine.finishRendering();
+			auto end = std::chrono::steady_clock::now();
+
+			frameTimes.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+		}
+
+		// Reports the frame times
+		std::cout << scene.name
+			<< ": p50 " << percentile(frameTimes, 0.50f) << " ms"
+			<< ", p95 " << percentile(frameTimes, 0.95f) << " ms"
+			<< ", p99 " << percentile(frameTimes, 0.99f) << " ms"
+			<< ", draw calls " << engine.getDrawCount() << std::endl;
+
+		// Compares the last frame against the golden image
+		std::string goldenPath = goldenDirectory + "/" + scene.name + ".png";
+
+		if (updateGolden)
+		{
+			std::filesystem::create_directories(goldenDirectory);
+
+			if (!engine.getLastReadback().saveToFile(goldenPath))
+				throw std::runtime_error("Error: could not write golden image " + goldenPath);
+
+			continue;
+		}
+
+		sf::Image golden;
+
+		if (!golden.loadFromFile(goldenPath))
+		{
+			std::cout << "  missing golden image " << goldenPath << " (run with --update-golden)" << std::endl;
+
+			// Without a golden image the scene is only reported
+			if (requireGolden)
+				failed = true;
+
+			continue;
+		}
+
+		float difference = compareImages(engine.getLastReadback(), golden);
+
+		if (difference > MAX_DIFFERENCE)
+		{
+			std::cout << "  frame does not match golden image (" << difference * 100.0f << "% of pixels differ)" << std::endl;
+			engine.getLastReadback().saveToFile(goldenDirectory + "/" + scene.name + ".actual.png");
+			failed = true;
+		}
+	}
+
+	return failed ? 1 : 0;
+}